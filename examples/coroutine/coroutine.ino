@@ -0,0 +1,60 @@
+// In this example the same sequence of delayed steps runs once as a coroutine and once as a chain of callbacks, and we measure the cost per step
+// The coroutine keeps its counter in a local variable, the callback chain passes it through arg and schedules the next step itself
+// Needs a compiler with C++20 coroutines, e.g. -std=c++20 in the build flags
+#include <ActionScheduler.h>
+#include <ActionSchedulerCoroutine.h>
+
+const uint16_t STEP_COUNT = 1000;
+ActionScheduler actionScheduler;
+uint16_t stepsDone = 0;
+
+#if ACTION_SCHEDULER_HAS_COROUTINES
+ActionTask coroutineSteps() {
+  for (uint16_t i = 0; i < STEP_COUNT; i++) {
+    co_await actionScheduler.delay(1);
+    stepsDone++;
+  }
+}
+
+ActionReturn_t callbackStep(void* arg){
+  uint16_t* remaining = (uint16_t*)arg;
+  stepsDone++;
+  if (--(*remaining) > 0) {
+    actionScheduler.schedule(1, callbackStep, remaining);
+  }
+  return ACTION_ONESHOT;
+}
+
+uint32_t runSteps() {
+  uint32_t start = micros();
+  while (stepsDone < STEP_COUNT) {
+    actionScheduler.proceed(1);
+  }
+  return micros() - start;
+}
+
+void printResult(const char* name, uint32_t spent) {
+  Serial.print(name);
+  Serial.print((float)spent / STEP_COUNT);
+  Serial.println(" us per step");
+}
+#endif
+
+void setup() {
+  Serial.begin(115200);
+#if ACTION_SCHEDULER_HAS_COROUTINES
+  stepsDone = 0;
+  coroutineSteps();
+  printResult("Coroutine: ", runSteps());
+
+  static uint16_t remaining = STEP_COUNT;
+  stepsDone = 0;
+  actionScheduler.schedule(1, callbackStep, &remaining);
+  printResult("Callback chain: ", runSteps());
+#else
+  Serial.println("This example needs C++20 coroutines");
+#endif
+}
+
+void loop() {
+}
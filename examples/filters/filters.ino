@@ -0,0 +1,77 @@
+// In this example we debounce, throttle and rate limit a storm of events, and measure what one event costs
+// Each event only stamps the helper, so the cost per event stays the same whatever the edge rate
+// and however many other actions are waiting in the timeline
+#include <ActionFilters.h>
+
+const byte buttonPin = 2;
+const uint32_t EDGES_PER_BURST = 1000;
+ActionScheduler actionScheduler;
+ActionDebouncer debouncer;
+ActionThrottler throttler;
+ActionTokenBucket tokenBucket;
+
+ActionReturn_t onSettled(void* arg){
+  Serial.println("Button settled");
+  return ACTION_ONESHOT;
+}
+
+ActionReturn_t onThrottled(void* arg){
+  Serial.println("At most every 100ms while the button chatters");
+  return ACTION_ONESHOT;
+}
+
+ActionReturn_t fillerTask(void* arg){
+  return ACTION_RELOAD;
+}
+
+void isrHandler() {
+  debouncer.trigger();
+  throttler.trigger();
+  if (tokenBucket.tryAcquire()) {
+    // at most 5 in a burst and 10 per second on average
+  }
+}
+
+uint32_t benchmark(uint8_t timelineLength) {
+  actionScheduler.clear();
+  for (uint8_t i = 0; i < timelineLength; i++) {
+    actionScheduler.scheduleReload(1000 + i, 1000, fillerTask, NULL);
+  }
+  uint32_t start = micros();
+  for (uint32_t i = 0; i < EDGES_PER_BURST; i++) {
+    isrHandler();
+  }
+  uint32_t spent = micros() - start;
+  debouncer.cancel();
+  throttler.cancel();
+  return spent;
+}
+
+void setup() {
+  Serial.begin(115200);
+  pinMode(buttonPin, INPUT_PULLUP);
+  debouncer.begin(actionScheduler, 50, onSettled, NULL);
+  throttler.begin(actionScheduler, 100, onThrottled, NULL);
+  tokenBucket.begin(actionScheduler, 5, 100);
+
+  // same cost per edge with an empty and with a crowded timeline
+  uint8_t lengths[] = {0, 16, 48};
+  for (uint8_t i = 0; i < sizeof(lengths); i++) {
+    uint32_t spent = benchmark(lengths[i]);
+    Serial.print("Timeline of ");
+    Serial.print(lengths[i]);
+    Serial.print(" actions: ");
+    Serial.print((float)spent / EDGES_PER_BURST);
+    Serial.println(" us per event");
+  }
+  actionScheduler.clear();
+
+  attachInterrupt(digitalPinToInterrupt(buttonPin), isrHandler, CHANGE);
+}
+
+void loop() {
+  static uint32_t lastTime = 0;
+  uint32_t nowTime = millis();
+  actionScheduler.proceed(nowTime - lastTime);
+  lastTime = nowTime;
+}
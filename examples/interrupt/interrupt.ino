@@ -1,6 +1,7 @@
 // In this example we demonstrate how ActionScheduler can be used on interrupt routine
 // The general idea is to push some function out from ISR context to normal execution context
 // e.g. Debounce a button, we definitely can't delay in ISR handler, but we can schedule a delayed check
+// With ACTION_SCHEDULER_UNIQUE_BUCKETS set, every bounce restarts the same pending check instead of taking a new node
 #include <ActionScheduler.h>
 
 const byte ledPin = 13;
@@ -19,7 +20,11 @@ ActionReturn_t deBounce(void* arg){
 }
 
 void isrHandler() {
+#if ACTION_SCHEDULER_UNIQUE_BUCKETS > 0
+  actionScheduler.scheduleUnique(DEBOUNCE_DELAY, deBounce, NULL, ACTION_UNIQUE_RESTART);
+#else
   actionScheduler.schedule(DEBOUNCE_DELAY, deBounce, NULL);
+#endif
 }
 
 void setup() {
@@ -0,0 +1,79 @@
+// In this example we check the order of actions sharing a deadline, also with a reload 0 action, and measure what keeping it costs on insertion
+// With ACTION_SCHEDULER_STABLE_ORDER (default) they run in the order they were scheduled
+// Build it again with ACTION_SCHEDULER_STABLE_ORDER=0 in the build flags to compare with the unordered fast mode
+#include <ActionScheduler.h>
+
+const uint8_t ACTIONS_PER_DEADLINE = 20;
+ActionScheduler actionScheduler;
+
+ActionReturn_t printOrder(void* arg){
+  Serial.print((uintptr_t)arg);
+  Serial.print(' ');
+  return ACTION_ONESHOT;
+}
+
+ActionReturn_t followUpTask(void* arg){
+  Serial.print('B');
+  Serial.print((uintptr_t)arg);
+  Serial.print(' ');
+  return ACTION_ONESHOT;
+}
+
+ActionReturn_t repeatTask(void* arg){
+  static uintptr_t runs = 0;
+  Serial.print('A');
+  Serial.print(runs);
+  Serial.print(' ');
+  // Scheduled with no delay, so it runs before the next run of this reload 0 action
+  actionScheduler.schedule(0, followUpTask, (void*)runs);
+  runs++;
+  return (runs < 3) ? ACTION_RELOAD : ACTION_ONESHOT;
+}
+
+ActionReturn_t fillerTask(void* arg){
+  return ACTION_ONESHOT;
+}
+
+uint32_t benchmark(uint8_t deadlines) {
+  actionScheduler.clear();
+  uint32_t start = micros();
+  // Round robin over the deadlines, so an insertion can't just go behind the previous one
+  // and has to find its place among the actions already waiting on its deadline
+  for (uint8_t i = 0; i < ACTIONS_PER_DEADLINE; i++) {
+    for (uint8_t d = 0; d < deadlines; d++) {
+      actionScheduler.schedule(100 + d, fillerTask, NULL);
+    }
+  }
+  uint32_t spent = micros() - start;
+  actionScheduler.clear();
+  return spent;
+}
+
+void setup() {
+  Serial.begin(115200);
+  Serial.print("Stable order: ");
+  Serial.println(ACTION_SCHEDULER_STABLE_ORDER ? "yes" : "no");
+
+  for (uintptr_t i = 0; i < 8; i++) {
+    actionScheduler.schedule(10, printOrder, (void*)i);
+  }
+  Serial.print("Run order: ");
+  actionScheduler.proceed(10);
+  Serial.println();
+
+  actionScheduler.scheduleReload(10, 0, repeatTask, NULL);
+  Serial.print("Reload 0: ");
+  actionScheduler.proceed(10);
+  Serial.println();
+
+  for (uint8_t deadlines = 1; deadlines <= 3; deadlines++) {
+    uint32_t spent = benchmark(deadlines);
+    Serial.print(deadlines);
+    Serial.print(" deadline(s): ");
+    Serial.print((float)spent / (ACTIONS_PER_DEADLINE * deadlines));
+    Serial.println(" us per schedule");
+  }
+}
+
+void loop() {
+}
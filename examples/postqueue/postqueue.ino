@@ -0,0 +1,65 @@
+// In this example several producer threads post actions to one scheduler, and we measure the throughput for each producer count
+// post() takes no lock, producers only race for a queue position, and the thread calling proceed() moves the actions into the timeline
+// Needs std::thread (host builds, ESP32) and ACTION_SCHEDULER_POST_QUEUE_SIZE in the build flags, e.g. 256
+#include <ActionScheduler.h>
+#include <atomic>
+#include <thread>
+
+const uint32_t POSTS_PER_PRODUCER = 20000;
+const uint8_t MAX_PRODUCERS = 4;
+ActionScheduler actionScheduler;
+std::atomic<uint32_t> executed(0);
+
+ActionReturn_t countTask(void* arg){
+  executed.fetch_add(1, std::memory_order_relaxed);
+  return ACTION_ONESHOT;
+}
+
+#if ACTION_SCHEDULER_POST_QUEUE_SIZE > 0
+void producer() {
+  for (uint32_t i = 0; i < POSTS_PER_PRODUCER; i++) {
+    while (!actionScheduler.post(0, countTask, NULL)) {
+      // The queue is full, let the consumer catch up
+      std::this_thread::yield();
+    }
+  }
+}
+
+uint32_t benchmark(uint8_t producers) {
+  std::thread threads[MAX_PRODUCERS];
+  uint32_t total = POSTS_PER_PRODUCER * producers;
+  executed = 0;
+  uint32_t start = micros();
+  for (uint8_t i = 0; i < producers; i++) {
+    threads[i] = std::thread(producer);
+  }
+  while (executed.load(std::memory_order_relaxed) < total) {
+    actionScheduler.proceed(0);
+    // Give the producers a turn when they share the core with us
+    std::this_thread::yield();
+  }
+  uint32_t spent = micros() - start;
+  for (uint8_t i = 0; i < producers; i++) {
+    threads[i].join();
+  }
+  return spent;
+}
+#endif
+
+void setup() {
+  Serial.begin(115200);
+#if ACTION_SCHEDULER_POST_QUEUE_SIZE > 0
+  for (uint8_t producers = 1; producers <= MAX_PRODUCERS; producers++) {
+    uint32_t spent = benchmark(producers);
+    Serial.print(producers);
+    Serial.print(" producer(s): ");
+    Serial.print((float)(POSTS_PER_PRODUCER * producers) * 1000 / spent);
+    Serial.println(" posts per ms");
+  }
+#else
+  Serial.println("Set ACTION_SCHEDULER_POST_QUEUE_SIZE in the build flags to run this example");
+#endif
+}
+
+void loop() {
+}
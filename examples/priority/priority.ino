@@ -0,0 +1,39 @@
+// In this example proceed() is called late, after two logging actions and a watchdog kick are all overdue
+// The watchdog kick has the highest priority, so it runs first although the logging actions were due earlier
+// Build it with ACTION_SCHEDULER_PRIORITY_LEVELS in the build flags, e.g. 4
+#include <ActionScheduler.h>
+
+ActionScheduler actionScheduler;
+
+ActionReturn_t logTask(void* arg){
+  Serial.print("log");
+  Serial.print((uintptr_t)arg);
+  Serial.print(' ');
+  return ACTION_ONESHOT;
+}
+
+ActionReturn_t watchdogKick(void* arg){
+  Serial.print("WATCHDOG ");
+  return ACTION_ONESHOT;
+}
+
+void setup() {
+  Serial.begin(115200);
+#if ACTION_SCHEDULER_PRIORITY_LEVELS > 1
+  ActionOptions_t options = {};
+  options.priority = ACTION_SCHEDULER_PRIORITY_LEVELS - 1;
+  actionScheduler.schedule(10, logTask, (void*)0);
+  actionScheduler.schedule(11, logTask, (void*)1);
+  actionScheduler.scheduleReload(12, 12, watchdogKick, NULL, options);
+
+  // The main loop was busy for 20 ticks
+  Serial.print("Run order: ");
+  actionScheduler.proceed(20);
+  Serial.println();
+#else
+  Serial.println("Set ACTION_SCHEDULER_PRIORITY_LEVELS above 1 in the build flags to run this example");
+#endif
+}
+
+void loop() {
+}
@@ -0,0 +1,64 @@
+// In this example a stream of actions lands on shard 0 while one event loop thread per shard runs them, and we measure the throughput for each shard count
+// The loops with nothing to do steal due actions from shard 0, so the work spreads over the shards
+// Needs std::thread, and noInterrupts()/interrupts() mapped to a lock as for any scheduler shared between threads (host builds)
+#include <ShardedActionScheduler.h>
+#include <atomic>
+#include <thread>
+
+const uint32_t ACTION_COUNT = 2000;
+const uint32_t WORK_US = 20;
+std::atomic<uint32_t> executed(0);
+
+ActionReturn_t workTask(void* arg){
+  uint32_t start = micros();
+  while (micros() - start < WORK_US) {
+  }
+  executed.fetch_add(1, std::memory_order_relaxed);
+  return ACTION_ONESHOT;
+}
+
+template <uint8_t SHARDS>
+void eventLoop(ShardedActionScheduler<SHARDS>* sharded, uint8_t shard) {
+  while (executed.load(std::memory_order_relaxed) < ACTION_COUNT) {
+    sharded->proceed(shard, 0);
+    std::this_thread::yield();
+  }
+}
+
+template <uint8_t SHARDS>
+void benchmark() {
+  static ShardedActionScheduler<SHARDS> sharded;
+  std::thread threads[SHARDS];
+  executed = 0;
+  uint32_t steals = sharded.getStealCount();
+  uint32_t start = micros();
+  for (uint8_t i = 0; i < SHARDS; i++) {
+    threads[i] = std::thread(eventLoop<SHARDS>, &sharded, i);
+  }
+  for (uint32_t i = 0; i < ACTION_COUNT; i++) {
+    while (sharded.scheduleOn(0, 0, 0, workTask, NULL) == SHARDED_ACTION_ID_INVALID) {
+      // Shard 0 is full, let the loops catch up
+      std::this_thread::yield();
+    }
+  }
+  for (uint8_t i = 0; i < SHARDS; i++) {
+    threads[i].join();
+  }
+  uint32_t spent = micros() - start;
+  Serial.print(SHARDS);
+  Serial.print(" shard(s): ");
+  Serial.print((float)spent / ACTION_COUNT);
+  Serial.print(" us per action, ");
+  Serial.print(sharded.getStealCount() - steals);
+  Serial.println(" stolen");
+}
+
+void setup() {
+  Serial.begin(115200);
+  benchmark<1>();
+  benchmark<2>();
+  benchmark<4>();
+}
+
+void loop() {
+}
@@ -0,0 +1,138 @@
+//
+// Author: windy.yam0@gmail.com
+//
+// Cyclic executive on top of ActionScheduler
+// A harmonic periodic task set is sorted once by period, so the table itself is the dispatch schedule:
+// in minor frame k, task i is due when k is a multiple of (period_i / minor frame)
+// Because the periods are harmonic, if task i is not due in a frame, no task with a longer period is due either
+// So each frame only walks the prefix of the table that actually runs, and stops at the first task that is not due
+// The whole set costs a single reload node in the scheduler timeline, the one-shot actions still go to the timeline as usual
+//
+#include "ActionCyclicExecutive.h"
+
+ActionCyclicExecutive::ActionCyclicExecutive()
+    : mTaskCount(0)
+    , mMinorFrame(0)
+    , mHyperFrames(0)
+    , mFrame(0)
+    , mScheduler(NULL)
+    , mFrameActionId(ACTION_SCHEDULER_ID_INVALID)
+{
+}
+
+bool ActionCyclicExecutive::addTask(uint32_t period, ActionCallback_t cb, void* arg) {
+    if ((cb == NULL) || (period == 0U) || (mTaskCount >= ACTION_CYCLIC_MAX_TASKS) || (mScheduler != NULL))
+    {
+        return false;
+    }
+    // keep the table sorted by period, equal periods keep the registration order
+    uint8_t i = mTaskCount;
+    while ((i > 0U) && (mTasks[i - 1U].period > period))
+    {
+        mTasks[i] = mTasks[i - 1U];
+        i--;
+    }
+    mTasks[i].callback = cb;
+    mTasks[i].arg = arg;
+    mTasks[i].period = period;
+    mTasks[i].frameDivider = 0U;
+    mTaskCount++;
+    return true;
+}
+
+bool ActionCyclicExecutive::start(ActionSchedulerCore& scheduler) {
+    if ((mTaskCount == 0U) || (mScheduler != NULL))
+    {
+        return false;
+    }
+    uint32_t minorFrame = mTasks[0].period;
+    for (uint8_t i = 1U; i < mTaskCount; i++)
+    {
+        if ((mTasks[i].period % mTasks[i - 1U].period) != 0U)
+        {
+            // not harmonic, this task set has to use the normal timeline
+            return false;
+        }
+    }
+    for (uint8_t i = 0U; i < mTaskCount; i++)
+    {
+        mTasks[i].frameDivider = mTasks[i].period / minorFrame;
+    }
+    mMinorFrame = minorFrame;
+    mHyperFrames = mTasks[mTaskCount - 1U].frameDivider;
+    mFrame = 0U;
+    mScheduler = &scheduler;
+    mFrameActionId = scheduler.schedule(minorFrame, onMinorFrame, this);
+    if (mFrameActionId == ACTION_SCHEDULER_ID_INVALID)
+    {
+        mScheduler = NULL;
+        mMinorFrame = 0U;
+        mHyperFrames = 0U;
+        return false;
+    }
+    return true;
+}
+
+void ActionCyclicExecutive::stop() {
+    if (mScheduler != NULL)
+    {
+        mScheduler->unschedule(&mFrameActionId);
+        mScheduler = NULL;
+    }
+    mMinorFrame = 0U;
+    mHyperFrames = 0U;
+    mFrame = 0U;
+}
+
+void ActionCyclicExecutive::clear() {
+    stop();
+    mTaskCount = 0U;
+}
+
+uint32_t ActionCyclicExecutive::getMinorFrame() {
+    return mMinorFrame;
+}
+
+uint32_t ActionCyclicExecutive::getHyperperiod() {
+    return mMinorFrame * mHyperFrames;
+}
+
+void ActionCyclicExecutive::dispatchFrame() {
+    mFrame++;
+    if (mFrame >= mHyperFrames)
+    {
+        // frame 0 of the next hyperperiod, every task is due
+        mFrame = 0U;
+    }
+    uint8_t i = 0U;
+    while ((i < mTaskCount) && ((mFrame % mTasks[i].frameDivider) == 0U))
+    {
+        if (mTasks[i].callback(mTasks[i].arg) == ACTION_ONESHOT)
+        {
+            // drop the task from the table, the order of the remaining tasks is kept
+            for (uint8_t j = i + 1U; j < mTaskCount; j++)
+            {
+                mTasks[j - 1U] = mTasks[j];
+            }
+            mTaskCount--;
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
+
+ActionReturn_t ActionCyclicExecutive::onMinorFrame(void* arg) {
+    ActionCyclicExecutive* self = (ActionCyclicExecutive*)arg;
+    self->dispatchFrame();
+    if (self->mTaskCount == 0U)
+    {
+        self->mScheduler = NULL;
+        self->mFrameActionId = ACTION_SCHEDULER_ID_INVALID;
+        self->mMinorFrame = 0U;
+        self->mHyperFrames = 0U;
+        return ACTION_ONESHOT;
+    }
+    return ACTION_RELOAD;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file ActionCyclicExecutive.h
+ * @brief A cyclic executive for harmonic periodic task sets, driven by an ActionScheduler.
+ * @author windy.yam0@gmail.com
+ *
+ * Periodic actions with harmonic periods (e.g. 1, 10, 100, 1000 ticks) don't need to be
+ * re-inserted into the timeline after every run. The cyclic executive sorts them once
+ * into a dispatch table at start(), derives the minor frame (shortest period) and the
+ * hyperperiod (longest period), and occupies a single reload node of the scheduler.
+ * Every minor frame only the table prefix that is due is dispatched, in a fixed order.
+ *
+ * Key features:
+ * - One timeline node for the whole periodic set, no insertion cost per task
+ * - Deterministic dispatch order: shorter period first, then registration order
+ * - One-shot and non-harmonic actions keep using the normal ActionScheduler timeline
+ */
+
+#ifndef ACTION_CYCLIC_EXECUTIVE_H
+#define ACTION_CYCLIC_EXECUTIVE_H
+
+#include <Arduino.h>
+#include "ActionScheduler.h"
+
+/**
+ * @brief Maximum number of periodic tasks one cyclic executive can hold
+ * @note Can be overridden in Arduino IDE, must not exceed 255
+ */
+#ifndef ACTION_CYCLIC_MAX_TASKS
+#define ACTION_CYCLIC_MAX_TASKS 8U
+#endif
+
+#if ACTION_CYCLIC_MAX_TASKS >= 255
+#error ACTION_CYCLIC_MAX_TASKS cannot exceed 255!
+#endif
+
+/**
+ * @class ActionCyclicExecutive
+ * @brief Dispatches a harmonic periodic task set from a precomputed minor frame table
+ *
+ * Tasks are registered with addTask() and the executive is attached to a scheduler
+ * with start(). Task callbacks follow the ActionScheduler convention: ACTION_RELOAD
+ * keeps the task in the table, ACTION_ONESHOT removes it.
+ */
+class ActionCyclicExecutive {
+public:
+    /**
+     * @brief Constructs an empty cyclic executive
+     */
+    ActionCyclicExecutive();
+
+    /**
+     * @brief Registers a periodic task
+     * @param period Task period in ticks, first execution happens after one period
+     * @param cb Callback function to execute
+     * @param arg User data to pass to callback
+     * @return true if the task was added, false if the table is full, the period is 0,
+     *         cb is NULL or the executive is already running
+     */
+    bool addTask(uint32_t period, ActionCallback_t cb, void* arg);
+
+    /**
+     * @brief Builds the dispatch table and starts the minor frame on a scheduler
+     * @param scheduler Scheduler that drives the minor frame
+     * @return true if started, false if the task set is empty, not harmonic
+     *         (every period must be a multiple of the next shorter one), or the
+     *         scheduler has no free node
+     */
+    bool start(ActionSchedulerCore& scheduler);
+
+    /**
+     * @brief Stops the minor frame, tasks stay registered and can be started again
+     */
+    void stop(void);
+
+    /**
+     * @brief Removes all tasks and stops the executive
+     */
+    void clear(void);
+
+    /**
+     * @brief Gets the minor frame length (shortest period) computed by start()
+     * @return Minor frame in ticks, 0 if not started
+     */
+    uint32_t getMinorFrame(void);
+
+    /**
+     * @brief Gets the hyperperiod (longest period) computed by start()
+     * @return Hyperperiod in ticks, 0 if not started
+     */
+    uint32_t getHyperperiod(void);
+
+private:
+    typedef struct {
+        ActionCallback_t callback;
+        void* arg;
+        uint32_t period;
+        uint32_t frameDivider;
+    } CyclicTask_t;
+
+    CyclicTask_t mTasks[ACTION_CYCLIC_MAX_TASKS];
+    uint8_t mTaskCount;
+    uint32_t mMinorFrame;
+    uint32_t mHyperFrames;
+    uint32_t mFrame;
+    ActionSchedulerCore* mScheduler;
+    ActionSchedulerId_t mFrameActionId;
+
+    void dispatchFrame(void);
+    static ActionReturn_t onMinorFrame(void* arg);
+};
+
+#endif /* ACTION_CYCLIC_EXECUTIVE_H */
@@ -0,0 +1,308 @@
+//
+// Author: windy.yam0@gmail.com
+//
+// Debounce, throttle and token bucket helpers on top of ActionScheduler
+// An event only stamps the helper state inside a short interrupt lock, it never walks the timeline
+// Only the first event of a burst arms a node, the node decides when it runs what is due:
+// the debouncer compares the last event stamp with the quiet time and moves its own deadline with setReload(),
+// so a burst of any length costs one insertion per quiet period instead of one per edge
+// The throttler keeps a fixed-delay reload node while events keep coming and releases it after an idle interval
+// The token bucket needs no node, it refills from the proceeding time whenever it is asked
+// Event stamps use the proceeding time, the same base the scheduler uses for delays scheduled from interrupts
+// The helpers never call into the scheduler while holding their interrupt lock, so the two locks are never nested
+//
+#include "ActionFilters.h"
+
+ActionDebouncer::ActionDebouncer()
+    : mScheduler(NULL)
+    , mCallback(NULL)
+    , mArg(NULL)
+    , mQuietTime(0)
+    , mLastEvent(0)
+    , mDue(0)
+    , mActionId(ACTION_SCHEDULER_ID_INVALID)
+    , mArmed(false)
+{
+}
+
+bool ActionDebouncer::begin(ActionSchedulerCore& scheduler, uint32_t quietTime, ActionCallback_t cb, void* arg) {
+    if ((cb == NULL) || (quietTime == 0U))
+    {
+        return false;
+    }
+    cancel();
+    mScheduler = &scheduler;
+    mCallback = cb;
+    mArg = arg;
+    mQuietTime = quietTime;
+    return true;
+}
+
+bool ActionDebouncer::trigger() {
+    if (mScheduler == NULL)
+    {
+        return false;
+    }
+    uint32_t now = mScheduler->getProceedingTime();
+    noInterrupts();
+    mLastEvent = now;
+    bool arm = !mArmed;
+    if (arm)
+    {
+        mArmed = true;
+        mDue = now + mQuietTime;
+    }
+    interrupts();
+    if (!arm)
+    {
+        // the pending node picks the new stamp up when it runs
+        return true;
+    }
+
+    ActionSchedulerId_t actionId = mScheduler->schedule(mQuietTime, onTimer, this);
+    noInterrupts();
+    if (actionId == ACTION_SCHEDULER_ID_INVALID)
+    {
+        mArmed = false;
+    }
+    else
+    {
+        mActionId = actionId;
+    }
+    interrupts();
+    return actionId != ACTION_SCHEDULER_ID_INVALID;
+}
+
+void ActionDebouncer::cancel() {
+    noInterrupts();
+    ActionSchedulerId_t actionId = mActionId;
+    mActionId = ACTION_SCHEDULER_ID_INVALID;
+    mArmed = false;
+    interrupts();
+    if (mScheduler != NULL)
+    {
+        mScheduler->unschedule(&actionId);
+    }
+}
+
+bool ActionDebouncer::isPending() {
+    return mArmed;
+}
+
+ActionReturn_t ActionDebouncer::onTimer(void* arg) {
+    ActionDebouncer* self = (ActionDebouncer*)arg;
+    uint32_t now = self->mScheduler->getProceedingTime();
+    noInterrupts();
+    if (!self->mArmed)
+    {
+        interrupts();
+        return ACTION_ONESHOT;
+    }
+    uint32_t target = self->mLastEvent + self->mQuietTime;
+    if ((int32_t)(target - now) > 0)
+    {
+        // events came in meanwhile, move the deadline to the end of the quiet period
+        // the reload is relative to the deadline this run was due at
+        uint32_t reload = target - self->mDue;
+        ActionSchedulerId_t actionId = self->mActionId;
+        self->mDue = target;
+        interrupts();
+        self->mScheduler->setReload(actionId, reload);
+        return ACTION_RELOAD;
+    }
+    self->mArmed = false;
+    self->mActionId = ACTION_SCHEDULER_ID_INVALID;
+    interrupts();
+    (void)self->mCallback(self->mArg);
+    return ACTION_ONESHOT;
+}
+
+ActionThrottler::ActionThrottler()
+    : mScheduler(NULL)
+    , mCallback(NULL)
+    , mArg(NULL)
+    , mInterval(0)
+    , mActionId(ACTION_SCHEDULER_ID_INVALID)
+    , mPending(false)
+    , mArmed(false)
+{
+}
+
+bool ActionThrottler::begin(ActionSchedulerCore& scheduler, uint32_t interval, ActionCallback_t cb, void* arg) {
+    if ((cb == NULL) || (interval == 0U) || mArmed)
+    {
+        return false;
+    }
+    mScheduler = &scheduler;
+    mCallback = cb;
+    mArg = arg;
+    mInterval = interval;
+    return true;
+}
+
+bool ActionThrottler::trigger() {
+    if (mScheduler == NULL)
+    {
+        return false;
+    }
+    noInterrupts();
+    mPending = true;
+    bool arm = !mArmed;
+    mArmed = true;
+    interrupts();
+    if (!arm)
+    {
+        return true;
+    }
+
+    // leading edge on the next proceed(), then at most one run per interval,
+    // counted from the previous run so a late proceed() can't bring two runs closer
+    ActionOptions_t options = {};
+    options.reloadMode = ACTION_RELOAD_FIXED_DELAY;
+    ActionSchedulerId_t actionId = mScheduler->scheduleReload(0U, mInterval, onTimer, this, options);
+    noInterrupts();
+    if (actionId == ACTION_SCHEDULER_ID_INVALID)
+    {
+        mPending = false;
+        mArmed = false;
+    }
+    else
+    {
+        mActionId = actionId;
+    }
+    interrupts();
+    return actionId != ACTION_SCHEDULER_ID_INVALID;
+}
+
+void ActionThrottler::cancel() {
+    noInterrupts();
+    ActionSchedulerId_t actionId = mActionId;
+    mActionId = ACTION_SCHEDULER_ID_INVALID;
+    mPending = false;
+    mArmed = false;
+    interrupts();
+    if (mScheduler != NULL)
+    {
+        mScheduler->unschedule(&actionId);
+    }
+}
+
+ActionReturn_t ActionThrottler::onTimer(void* arg) {
+    ActionThrottler* self = (ActionThrottler*)arg;
+    noInterrupts();
+    bool run = self->mPending;
+    self->mPending = false;
+    if (!run)
+    {
+        // a whole interval without events, give the node back
+        self->mArmed = false;
+        self->mActionId = ACTION_SCHEDULER_ID_INVALID;
+    }
+    interrupts();
+    if (!run)
+    {
+        return ACTION_ONESHOT;
+    }
+    (void)self->mCallback(self->mArg);
+    return ACTION_RELOAD;
+}
+
+ActionTokenBucket::ActionTokenBucket()
+    : mScheduler(NULL)
+    , mCapacity(0)
+    , mTokens(0)
+    , mRefillPeriod(0)
+    , mLastRefill(0)
+{
+}
+
+bool ActionTokenBucket::begin(ActionSchedulerCore& scheduler, uint16_t capacity, uint32_t refillPeriod) {
+    if ((capacity == 0U) || (refillPeriod == 0U))
+    {
+        return false;
+    }
+    uint32_t now = scheduler.getProceedingTime();
+    noInterrupts();
+    mScheduler = &scheduler;
+    mCapacity = capacity;
+    mTokens = capacity;
+    mRefillPeriod = refillPeriod;
+    mLastRefill = now;
+    interrupts();
+    return true;
+}
+
+void ActionTokenBucket::refill(uint32_t now) {
+    if ((int32_t)(now - mLastRefill) < 0)
+    {
+        // the proceeding time went back, e.g. clearProceedingTime(), restart the period from now
+        mLastRefill = now;
+        return;
+    }
+    uint32_t elapsed = now - mLastRefill;
+    if (elapsed < mRefillPeriod)
+    {
+        return;
+    }
+    uint32_t gained = elapsed / mRefillPeriod;
+    if (gained >= (uint32_t)(mCapacity - mTokens))
+    {
+        // full, the time spent full does not count towards the next token
+        mTokens = mCapacity;
+        mLastRefill = now;
+    }
+    else
+    {
+        mTokens = (uint16_t)(mTokens + gained);
+        uint32_t lastRefill = mLastRefill;
+        mLastRefill = lastRefill + (gained * mRefillPeriod);
+    }
+}
+
+bool ActionTokenBucket::tryAcquire(uint16_t tokens) {
+    if (mScheduler == NULL)
+    {
+        return false;
+    }
+    bool ret = false;
+    uint32_t now = mScheduler->getProceedingTime();
+    noInterrupts();
+    refill(now);
+    if (mTokens >= tokens)
+    {
+        mTokens = (uint16_t)(mTokens - tokens);
+        ret = true;
+    }
+    interrupts();
+    return ret;
+}
+
+uint16_t ActionTokenBucket::getTokens() {
+    if (mScheduler == NULL)
+    {
+        return 0U;
+    }
+    uint32_t now = mScheduler->getProceedingTime();
+    noInterrupts();
+    refill(now);
+    uint16_t ret = mTokens;
+    interrupts();
+    return ret;
+}
+
+uint32_t ActionTokenBucket::getWaitTime() {
+    if (mScheduler == NULL)
+    {
+        return 0U;
+    }
+    uint32_t ret = 0U;
+    uint32_t now = mScheduler->getProceedingTime();
+    noInterrupts();
+    refill(now);
+    if (mTokens == 0U)
+    {
+        ret = mRefillPeriod - (now - mLastRefill);
+    }
+    interrupts();
+    return ret;
+}
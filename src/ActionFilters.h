@@ -0,0 +1,179 @@
+/**
+ * @file ActionFilters.h
+ * @brief Debounce, throttle and token bucket rate limiting on top of an ActionScheduler.
+ * @author windy.yam0@gmail.com
+ *
+ * Hand-written debounce or throttle logic usually unschedules and schedules again on
+ * every edge, paying a slot allocation and a timeline walk per event. These helpers
+ * only record the event in O(1) and let a single node, armed on the first event of a
+ * burst, decide later what is due. Event calls are safe from interrupt handlers.
+ *
+ * Key features:
+ * - Constant cost per event, independent of the edge rate and of the timeline length
+ * - At most one scheduler node per helper, only while a burst is being handled
+ * - Time is taken from the scheduler proceeding time, no extra clock is needed
+ */
+
+#ifndef ACTION_FILTERS_H
+#define ACTION_FILTERS_H
+
+#include <Arduino.h>
+#include "ActionScheduler.h"
+
+/**
+ * @class ActionDebouncer
+ * @brief Runs a callback once the events have been quiet for a given time (trailing edge)
+ */
+class ActionDebouncer {
+public:
+    /**
+     * @brief Constructs an idle debouncer
+     */
+    ActionDebouncer();
+
+    /**
+     * @brief Attaches the debouncer to a scheduler
+     * @param scheduler Scheduler that times the quiet period
+     * @param quietTime Time without events before the callback runs, in ticks
+     * @param cb Callback function to execute, its return value is ignored
+     * @param arg User data to pass to callback
+     * @return true if attached, false if cb is NULL or quietTime is 0
+     */
+    bool begin(ActionSchedulerCore& scheduler, uint32_t quietTime, ActionCallback_t cb, void* arg);
+
+    /**
+     * @brief Records an event, O(1) except for the first event of a burst which arms the node
+     * @return true if the event is tracked, false if not attached or the scheduler has no free node
+     *
+     * Can be safely called from interrupt handlers.
+     */
+    bool trigger(void);
+
+    /**
+     * @brief Drops a pending burst without running the callback
+     */
+    void cancel(void);
+
+    /**
+     * @brief Checks if a burst is waiting for its quiet period
+     * @return true if the callback is going to run
+     */
+    bool isPending(void);
+
+private:
+    ActionSchedulerCore* mScheduler;
+    ActionCallback_t mCallback;
+    void* mArg;
+    uint32_t mQuietTime;
+    volatile uint32_t mLastEvent;
+    volatile uint32_t mDue;
+    volatile ActionSchedulerId_t mActionId;
+    volatile bool mArmed;
+
+    static ActionReturn_t onTimer(void* arg);
+};
+
+/**
+ * @class ActionThrottler
+ * @brief Runs a callback at most once per interval while events keep coming
+ *
+ * The first event of a burst runs the callback on the next proceed(), further events
+ * within the interval are merged into a single run at the end of the interval.
+ */
+class ActionThrottler {
+public:
+    /**
+     * @brief Constructs an idle throttler
+     */
+    ActionThrottler();
+
+    /**
+     * @brief Attaches the throttler to a scheduler
+     * @param scheduler Scheduler that times the interval
+     * @param interval Minimum time between two runs of the callback, in ticks
+     * @param cb Callback function to execute, its return value is ignored
+     * @param arg User data to pass to callback
+     * @return true if attached, false if cb is NULL or interval is 0
+     */
+    bool begin(ActionSchedulerCore& scheduler, uint32_t interval, ActionCallback_t cb, void* arg);
+
+    /**
+     * @brief Records an event, O(1) except for the first event of a burst which arms the node
+     * @return true if the event is tracked, false if not attached or the scheduler has no free node
+     *
+     * Can be safely called from interrupt handlers.
+     */
+    bool trigger(void);
+
+    /**
+     * @brief Drops the pending events and releases the node
+     */
+    void cancel(void);
+
+private:
+    ActionSchedulerCore* mScheduler;
+    ActionCallback_t mCallback;
+    void* mArg;
+    uint32_t mInterval;
+    volatile ActionSchedulerId_t mActionId;
+    volatile bool mPending;
+    volatile bool mArmed;
+
+    static ActionReturn_t onTimer(void* arg);
+};
+
+/**
+ * @class ActionTokenBucket
+ * @brief Token bucket rate limiter, refilled lazily from the scheduler proceeding time
+ *
+ * Allows bursts up to the bucket capacity and an average of one token per refill
+ * period. It needs no scheduler node at all, the refill is computed on each call.
+ */
+class ActionTokenBucket {
+public:
+    /**
+     * @brief Constructs an empty, unattached bucket
+     */
+    ActionTokenBucket();
+
+    /**
+     * @brief Attaches the bucket to a scheduler and fills it
+     * @param scheduler Scheduler providing the time base
+     * @param capacity Maximum number of tokens (burst size)
+     * @param refillPeriod Time to gain one token, in ticks
+     * @return true if attached, false if capacity or refillPeriod is 0
+     */
+    bool begin(ActionSchedulerCore& scheduler, uint16_t capacity, uint32_t refillPeriod);
+
+    /**
+     * @brief Takes tokens if enough are available
+     * @param tokens Number of tokens to take
+     * @return true if the tokens were taken, false if the caller is rate limited
+     *
+     * Can be safely called from interrupt handlers.
+     */
+    bool tryAcquire(uint16_t tokens = 1U);
+
+    /**
+     * @brief Gets the number of tokens currently available
+     * @return Available tokens
+     */
+    uint16_t getTokens(void);
+
+    /**
+     * @brief Gets the time until the next token is available
+     * @return Ticks to wait, 0 if a token is available now
+     */
+    uint32_t getWaitTime(void);
+
+private:
+    ActionSchedulerCore* mScheduler;
+    uint16_t mCapacity;
+    volatile uint16_t mTokens;
+    uint32_t mRefillPeriod;
+    volatile uint32_t mLastRefill;
+
+    void refill(uint32_t now);
+};
+
+#endif /* ACTION_FILTERS_H */
@@ -0,0 +1,88 @@
+//
+// Author: windy.yam0@gmail.com
+//
+// Shared node pool for ActionSchedulerCore instances
+// The nodes are cut into slabs of ACTION_SCHEDULER_SLAB_NODES, a free slab keeps the link to the next free one in the arg
+// of its first node, so acquiring and releasing a slab is a push or a pop on that stack
+// Schedulers only call in from their own critical section, so the pool lock is never taken with interrupts enabled
+// on a single core, and an interrupt can't spin on a lock held by the code it interrupted
+// The lock is a spin lock for the schedulers living on other cores or threads, it is held for a few instructions only
+// The counters are written under the lock and read with atomic loads, so reading the metrics never takes it
+//
+#include "ActionNodePool.h"
+
+#if ACTION_SCHEDULER_ENABLE_NODE_POOL
+
+ActionNodePool::ActionNodePool(ActionNode_t* nodes, uint32_t nodeCount)
+    : mFreeSlabs(NULL)
+    , mSlabCount((nodes == NULL) ? 0U : (nodeCount / ACTION_SCHEDULER_SLAB_NODES))
+    , mUsedSlabs(0)
+    , mSlabWaterMark(0)
+    , mExhaustedCount(0)
+    , mLock(0)
+{
+    // push them in reverse so the slabs are handed out in address order
+    for (uint32_t i = mSlabCount; i > 0U; i--)
+    {
+        ActionNode_t* slab = &nodes[(i - 1U) * ACTION_SCHEDULER_SLAB_NODES];
+        slab->arg = mFreeSlabs;
+        mFreeSlabs = slab;
+    }
+}
+
+void ActionNodePool::lock() {
+    while (__atomic_test_and_set(&mLock, __ATOMIC_ACQUIRE))
+    {
+        // another core is pushing or popping a slab, that's a few instructions
+    }
+}
+
+void ActionNodePool::unlock() {
+    __atomic_clear(&mLock, __ATOMIC_RELEASE);
+}
+
+ActionNodePool::ActionNode_t* ActionNodePool::acquireSlab() {
+    lock();
+    ActionNode_t* slab = mFreeSlabs;
+    if (slab != NULL)
+    {
+        mFreeSlabs = (ActionNode_t*)slab->arg;
+        __atomic_store_n(&mUsedSlabs, mUsedSlabs + 1U, __ATOMIC_RELAXED);
+        if (mUsedSlabs > mSlabWaterMark)
+        {
+            __atomic_store_n(&mSlabWaterMark, mUsedSlabs, __ATOMIC_RELAXED);
+        }
+    }
+    else
+    {
+        __atomic_store_n(&mExhaustedCount, mExhaustedCount + 1U, __ATOMIC_RELAXED);
+    }
+    unlock();
+    return slab;
+}
+
+void ActionNodePool::releaseSlab(ActionNode_t* slab) {
+    lock();
+    slab->arg = mFreeSlabs;
+    mFreeSlabs = slab;
+    __atomic_store_n(&mUsedSlabs, mUsedSlabs - 1U, __ATOMIC_RELAXED);
+    unlock();
+}
+
+uint32_t ActionNodePool::getSlabCount() {
+    return mSlabCount;
+}
+
+uint32_t ActionNodePool::getUsedSlabCount() {
+    return __atomic_load_n(&mUsedSlabs, __ATOMIC_RELAXED);
+}
+
+uint32_t ActionNodePool::getSlabWaterMark() {
+    return __atomic_load_n(&mSlabWaterMark, __ATOMIC_RELAXED);
+}
+
+uint32_t ActionNodePool::getExhaustedCount() {
+    return __atomic_load_n(&mExhaustedCount, __ATOMIC_RELAXED);
+}
+
+#endif
@@ -0,0 +1,100 @@
+/**
+ * @file ActionNodePool.h
+ * @brief A shared, thread-safe pool of scheduler nodes handed out in slabs.
+ * @author windy.yam0@gmail.com
+ *
+ * A service with one scheduler per client session would otherwise pay a full node array
+ * per instance, while most of them sit idle. Schedulers constructed on a pool hold no
+ * nodes of their own: they take a slab of ACTION_SCHEDULER_SLAB_NODES nodes when they run
+ * out of free nodes and give it back as soon as its last action is released, so the memory
+ * follows the actions actually pending. Each scheduler is limited by its own quota.
+ *
+ * Key features:
+ * - O(1) slab acquire and release, from any scheduler, any thread or interrupt
+ * - Per-instance quota, set as the capacity of the scheduler
+ * - Occupancy metrics readable without taking the pool lock
+ *
+ * Needs ACTION_SCHEDULER_ENABLE_NODE_POOL.
+ */
+
+#ifndef ACTION_NODE_POOL_H
+#define ACTION_NODE_POOL_H
+
+#include <Arduino.h>
+#include "ActionScheduler.h"
+
+#if ACTION_SCHEDULER_ENABLE_NODE_POOL
+
+/**
+ * @class ActionNodePool
+ * @brief Slab pool shared by any number of ActionSchedulerCore instances
+ */
+class ActionNodePool {
+public:
+    /**
+     * @brief Type of the nodes the pool is built from
+     */
+    typedef ActionSchedulerCore::ActionNode_t ActionNode_t;
+
+    /**
+     * @brief Constructs a pool on top of user provided node storage
+     * @param nodes Node buffer, e.g. a static ActionNode_t array or a suitably aligned memory region
+     * @param nodeCount Number of nodes in the buffer, a remainder smaller than a slab is not used
+     *
+     * The buffer must outlive the pool, and the pool must outlive the schedulers using it.
+     */
+    ActionNodePool(ActionNode_t* nodes, uint32_t nodeCount);
+
+    /**
+     * @brief Gets the number of bytes of node storage needed for a number of slabs
+     * @param slabCount Number of slabs
+     * @return Size of the buffer to pass to the constructor, in bytes
+     */
+    static size_t requiredBytes(uint32_t slabCount) {
+        return (size_t)slabCount * ACTION_SCHEDULER_SLAB_NODES * sizeof(ActionNode_t);
+    }
+
+    /**
+     * @brief Gets the total number of slabs in the pool
+     * @return Number of slabs
+     */
+    uint32_t getSlabCount(void);
+
+    /**
+     * @brief Gets the number of slabs currently held by schedulers
+     * @return Number of slabs in use
+     */
+    uint32_t getUsedSlabCount(void);
+
+    /**
+     * @brief Gets the maximum number of slabs held at once
+     * @return Maximum number of slabs in use since the pool was constructed
+     */
+    uint32_t getSlabWaterMark(void);
+
+    /**
+     * @brief Gets the number of times a scheduler asked for a slab while the pool was empty
+     * @return Number of failed slab requests
+     */
+    uint32_t getExhaustedCount(void);
+
+private:
+    friend class ActionSchedulerCore;
+
+    // Free slabs form a stack linked through the arg of their first node
+    ActionNode_t* mFreeSlabs;
+    uint32_t mSlabCount;
+    uint32_t mUsedSlabs;
+    uint32_t mSlabWaterMark;
+    uint32_t mExhaustedCount;
+    uint8_t mLock;
+
+    ActionNode_t* acquireSlab(void);
+    void releaseSlab(ActionNode_t* slab);
+    void lock(void);
+    void unlock(void);
+};
+
+#endif
+
+#endif /* ACTION_NODE_POOL_H */
@@ -3,6 +3,7 @@
 //
 // The main purpose of this module is to provide a convenient way of scheduling a delayed function call or periodic function call
 // This module use a timeline based linked list to manage the schedule function calls. The linked list is statically allocated in an array without heap involved
+// The array is either inside ActionScheduler or handed to ActionSchedulerCore by the user, so each instance can be sized on its own
 // The earlier node will always be closer to the (logical) head, later node to the (logical) tail
 // New events will be inserted into timeline based on the relative time
 // Thus, the efficiency is guaranteed as we don't need to travse the whole linked list every time we proceed the time
@@ -13,99 +14,387 @@
 // A schedule is simply an invocation Schedule, no any configuration needed, no static data needed, just the function, the arg and the delay
 // The arg is a void pointer which normally is 4 bytes, that you can cast into anything like integer, float, bool, or generically a pointer to your data
 // For unschedule, the safety is enforced by local counter and magic number, so unscheduling an expired event won't cause too much trouble at the moment
+// Nodes sharing the same deadline are grouped: the last inserted node is kept as an anchor, and a node landing on the anchor's deadline
+// is linked right behind it (after the ones already grouped there) without walking the timeline from the head
+// So K periodic tasks with the same period and phase cost one timeline walk per period instead of K
+// When time is proceeded, every node due within the elapsed time is first moved out of the timeline into a ready queue of its priority
+// The ready queues are intrusive lists kept in deadline order, and the highest non-empty priority is always dispatched first
+// So when proceed() is called late, the critical nodes don't wait behind the ones whose deadlines passed earlier
+// The proceeding time catches up with the deadline of each node as it runs, so a callback chain stays relative to its own deadline
+// A node re-armed by an executor after its next period has passed goes straight back to its ready queue
+// With completion deadlines enabled, the ready queues are ordered by release + deadline instead, which is earliest-deadline-first
+// A deadline is missed when the callback starts after it, or, if a clock is given, when the callback returns after it
+// Producer threads on a host can post actions into a bounded lock-free queue instead of taking the scheduler lock
+// Each queue cell has a sequence number: producers claim a position with a CAS and publish the cell by bumping its sequence
+// The thread running proceed() is the only consumer, it drains the queue into the timeline at the start of every pass
+// With an executor, proceed() hands the due nodes over instead of calling them, the nodes stay in the running state meanwhile
+// The worker reports back with complete(), which re-arms a reload node under the lock, relative to the deadline it was due at
+// scheduleUnique() keeps at most one pending node per (callback, arg): those nodes are also chained in a small hash index
+// So an ISR storm re-scheduling the same action finds the pending node in O(1) and keeps, restarts or advances it
+// With reservation classes every slot is accounted to a class on allocation and release, in O(1)
+// The reserved slots a class does not hold yet are counted in mReservedIdle: a class beyond its own reservation
+// only gets a slot while more slots are free than that, so the reservations of the others stay available
+// When the pool is full the overflow policy decides: reject, evict the timeline tail (the latest deadline) if the new action
+// is due earlier, or keep the action in a heap-backed spill store sorted by deadline, merged back whenever proceed() frees a node
+// With a node pool the nodes are reached through a slab table, a slab is attached when no free node is left
+// and detached when its last node is released, so an idle scheduler holds no nodes at all
+// The time base is extended to 64 bits by counting the wraps of mProceedingTime, the nodes keep 32-bit relative delays
+// scheduleLong() parks a node with a delay beyond the horizon in a separate unsorted list, holding its 64-bit deadline
+// The list is scanned every half horizon and the nodes less than a horizon away are moved into the timeline
+// A fractional period keeps its integer part in reload and carries the remainder in a per-node accumulator,
+// every re-arm adds the numerator and takes one extra tick when it reaches the denominator, integer math only
+// A reload is fixed-rate by default, relative to the deadline the node was due at, so lateness never shifts its phase
+// A fixed-delay node is re-armed relative to its completion: the end of the elapsed time it ran at plus the run time from the clock
+// scheduleAt() and scheduleReloadAt() turn an absolute time into a delay inside the critical section, against mProceedingTime
+// proceedWindow() also collects the nodes due within its window, they are queued with their future deadline and run early
+// peekNext() walks the first k timeline nodes, peekNextLockFree() does the same as a sequence lock reader
+// A group keeps a doubly linked list of its nodes through the slots, so cancelling it only visits its own nodes
+// A suspended group holds its nodes out of the timeline with their remaining time, linkNode() and pushReadyNode() freeze
+// any node of the group that would enter them meanwhile, and resumeGroup() links them back
+// Every time is a count of ticks of ACTION_SCHEDULER_TICK_US, the engine only relies on wrap-safe 32-bit differences
+// Every critical section is also the write side of a sequence lock: the sequence is odd while the state is being changed
+// So the queries (next event delay, proceeding time, counters) read without the lock and retry if a writer got in between
+// That keeps an idle thread or an ISR polling them from blocking the writer, and avoids torn 32-bit reads on 8-bit MCUs
+// The sequence is 32-bit except on AVR, where a reader is only interrupted, so it can't miss 256 writes and see the same value
 //
 #include "ActionScheduler.h"
+#include "ActionNodePool.h"
 
-ActionScheduler::ActionScheduler() 
-    : mNodeStartIdx(0)
+ActionSchedulerCore::ActionSchedulerCore(ActionNode_t* nodes, uint8_t capacity)
+#if !ACTION_SCHEDULER_ENABLE_NODE_POOL
+    : mNodes(nodes)
+    , mCapacity((nodes == NULL) ? 0U : ((capacity > ACTION_SCHEDULER_MAX_CAPACITY) ? (uint8_t)ACTION_SCHEDULER_MAX_CAPACITY : capacity))
+#else
+    : mPool(NULL)
+    , mCapacity((nodes == NULL) ? 0U : ((capacity > ACTION_SCHEDULER_MAX_CAPACITY) ? (uint8_t)ACTION_SCHEDULER_MAX_CAPACITY : capacity))
+#endif
+    , mNodeStartIdx(0)
     , mNodeEndIdx(0)
     , mActiveNodes(0)
     , mProceedingTime(0)
+    , mProceedingEpoch(0)
+    , mParkedHead(UINT8_MAX)
+    , mHorizonCheck(0)
+    , mCollectWindow(0)
     , mActiveNodesWaterMark(0)
+    , mGroupAnchorIdx(UINT8_MAX)
+    , mGroupAnchorCounter(0)
+    , mGroupAnchorDeadline(0)
+    , mReadyMask(0)
+    , mClock(NULL)
+#if ACTION_SCHEDULER_ENABLE_DEADLINES
+    , mDeadlineMissHook(NULL)
+    , mDeadlineMissCount(0)
+#endif
+    , mSequence(0)
+#if ACTION_SCHEDULER_ENABLE_EXECUTOR
+    , mExecutor(NULL)
+    , mExecutorContext(NULL)
+#endif
+#if ACTION_SCHEDULER_ENABLE_OVERFLOW_POLICY
+    , mOverflowPolicy(ACTION_OVERFLOW_REJECT)
+    , mRejectedCount(0)
+    , mEvictedCount(0)
+    , mSpilledCount(0)
+#endif
+#if ACTION_SCHEDULER_ENABLE_SPILL
+    , mSpill(NULL)
+    , mSpillCount(0)
+    , mSpillCapacity(0)
+#endif
 {
+#if ACTION_SCHEDULER_RESERVE_CLASSES > 0
+    for (uint8_t i = 0; i < ACTION_SCHEDULER_RESERVE_CLASSES; i++)
+    {
+        mClassReserved[i] = 0U;
+    }
+#endif
+#if ACTION_SCHEDULER_ENABLE_NODE_POOL
+    for (uint8_t slab = 0; slab < ACTION_SCHEDULER_MAX_SLABS; slab++)
+    {
+        // a user buffer is cut into slabs that stay attached for the life of the scheduler
+        mSlabs[slab] = (((uint16_t)slab * ACTION_SCHEDULER_SLAB_NODES) < mCapacity) ? &nodes[slab * ACTION_SCHEDULER_SLAB_NODES] : NULL;
+        mSlabSeed[slab] = 0U;
+    }
+#endif
+#if ACTION_SCHEDULER_POST_QUEUE_SIZE > 0
+    for (uint16_t i = 0; i < ACTION_SCHEDULER_POST_QUEUE_SIZE; i++)
+    {
+        mPostCells[i].sequence = i;
+    }
+    mPostEnqueuePos = 0;
+    mPostDequeuePos = 0;
+#endif
     clear();
 }
 
-bool ActionScheduler::getFreeSlot(uint8_t* slotIdx) {
+#if ACTION_SCHEDULER_ENABLE_NODE_POOL
+ActionSchedulerCore::ActionSchedulerCore(ActionNodePool& pool, uint8_t quota)
+    : ActionSchedulerCore(NULL, 0U)
+{
+    // no nodes of its own, the slabs are attached as the actions come
+    mPool = &pool;
+    mCapacity = (quota > ACTION_SCHEDULER_MAX_CAPACITY) ? (uint8_t)ACTION_SCHEDULER_MAX_CAPACITY : quota;
+}
+#endif
+
+ActionScheduler::ActionScheduler()
+    : ActionSchedulerCore(mNodeStorage, ACTION_SCHEDULER_MAX_NODES)
+{
+}
+
+uint8_t ActionSchedulerCore::getCapacity() {
+    return mCapacity;
+}
+
+#if ACTION_SCHEDULER_ENABLE_SPILL || ACTION_SCHEDULER_ENABLE_NODE_POOL
+ActionSchedulerCore::~ActionSchedulerCore() {
+#if ACTION_SCHEDULER_ENABLE_SPILL
+    free(mSpill);
+#endif
+#if ACTION_SCHEDULER_ENABLE_NODE_POOL
+    if (mPool != NULL)
+    {
+        for (uint8_t slab = 0; slab < ACTION_SCHEDULER_MAX_SLABS; slab++)
+        {
+            if (mSlabs[slab] != NULL)
+            {
+                mPool->releaseSlab(mSlabs[slab]);
+            }
+        }
+    }
+#endif
+}
+#endif
+
+void ActionSchedulerCore::enterCriticalSection() {
+    noInterrupts();
+    __atomic_store_n(&mSequence, (ActionSequence_t)(mSequence + 1U), __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void ActionSchedulerCore::exitCriticalSection() {
+    __atomic_store_n(&mSequence, (ActionSequence_t)(mSequence + 1U), __ATOMIC_RELEASE);
+    interrupts();
+}
+
+ActionSchedulerCore::ActionSequence_t ActionSchedulerCore::readBegin() {
+    ActionSequence_t sequence;
+    do {
+        // odd means a writer is in the middle of an update
+        sequence = __atomic_load_n(&mSequence, __ATOMIC_ACQUIRE);
+    } while ((sequence & 1U) != 0U);
+    return sequence;
+}
+
+bool ActionSchedulerCore::readRetry(ActionSequence_t sequence) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&mSequence, __ATOMIC_RELAXED) != sequence;
+}
+
+bool ActionSchedulerCore::getFreeSlot(uint8_t* slotIdx) {
     bool ret = false;
-    //find next available slot starting from the end
-    for (uint8_t i = (mNodeEndIdx + 1U) % ACTION_SCHEDULER_MAX_NODES; 
-         i != mNodeEndIdx; 
-         i = (i + 1U) % ACTION_SCHEDULER_MAX_NODES)
+    //find next available slot starting after the given one, the given one is checked last
+    uint8_t i = *slotIdx;
+    for (uint16_t n = 0; n < mCapacity; n++)
     {
-        if (mNodes[i].callback == NULL)
+        i = ((uint16_t)(i + 1U) >= mCapacity) ? 0U : (uint8_t)(i + 1U);
+        if (hasNodeAt(i) && (nodeAt(i).state == ACTION_NODE_FREE))
         {
             *slotIdx = i;
             ret = true;
             break;
         }
     }
+#if ACTION_SCHEDULER_ENABLE_NODE_POOL
+    if (!ret && (mPool != NULL))
+    {
+        ret = attachSlab(slotIdx);
+    }
+#endif
     return ret;
 }
 
-uint16_t ActionScheduler::generateActionIdAt(uint8_t idx) {
-    return idx | ((uint16_t)mNodes[idx].usedCounter << 8);
+#if ACTION_SCHEDULER_ENABLE_NODE_POOL
+bool ActionSchedulerCore::attachSlab(uint8_t* slotIdx) {
+    // the first slab position within the quota that has no slab
+    uint8_t slab = 0U;
+    while ((((uint16_t)slab * ACTION_SCHEDULER_SLAB_NODES) < mCapacity) && (mSlabs[slab] != NULL))
+    {
+        slab++;
+    }
+    if (((uint16_t)slab * ACTION_SCHEDULER_SLAB_NODES) >= mCapacity)
+    {
+        return false;
+    }
+    ActionNode_t* nodes = mPool->acquireSlab();
+    if (nodes == NULL)
+    {
+        return false;
+    }
+    for (uint8_t i = 0; i < ACTION_SCHEDULER_SLAB_NODES; i++)
+    {
+        // keep counting up from the IDs given out before the slab was detached, so stale IDs don't match
+        nodes[i].usedCounter = mSlabSeed[slab];
+        nodes[i].callback = NULL;
+        nodes[i].arg = NULL;
+        nodes[i].state = ACTION_NODE_FREE;
+        nodes[i].flags = 0U;
+#if ACTION_SCHEDULER_UNIQUE_BUCKETS > 0
+        nodes[i].uniqueNextIdx = UINT8_MAX;
+#endif
+    }
+    __atomic_store_n(&mSlabs[slab], nodes, __ATOMIC_RELAXED);
+    mSlabUsed[slab] = 0U;
+    *slotIdx = (uint8_t)(slab * ACTION_SCHEDULER_SLAB_NODES);
+    return true;
 }
 
-void ActionScheduler::removeNodeAt(uint8_t idx) {
-    if(idx < ACTION_SCHEDULER_MAX_NODES)
+void ActionSchedulerCore::detachSlab(uint8_t slab) {
+    ActionNode_t* nodes = mSlabs[slab];
+    uint8_t seed = mSlabSeed[slab];
+    for (uint8_t i = 0; i < ACTION_SCHEDULER_SLAB_NODES; i++)
     {
-        mNodes[idx].callback = NULL;
-        if (mActiveNodes > 1U)
+        if ((uint8_t)(nodes[i].usedCounter - seed) < 0x80U)
         {
-            if (idx == mNodeStartIdx)
-            {
-                uint8_t nextCursor = mNodes[idx].nextNodeIdx;
-                mNodes[nextCursor].previousNodeIdx = nextCursor;
-                mActiveNodes -= 1U;
-                uint32_t timeleft = mNodes[mNodeStartIdx].delayToPrevious;
-                mNodeStartIdx = nextCursor;
-                mNodes[mNodeStartIdx].delayToPrevious += timeleft;
-            }
-            else if (idx == mNodeEndIdx)
-            {
-                uint8_t previousCursor = mNodes[idx].previousNodeIdx;
-                mNodes[previousCursor].nextNodeIdx = previousCursor;
-                mNodeEndIdx = previousCursor;
-                mActiveNodes -= 1U;
-            }
-            else
-            {
-                if((mNodes[idx].previousNodeIdx == idx) && (mNodes[idx].nextNodeIdx == idx))
+            seed = nodes[i].usedCounter;
+        }
+    }
+    mSlabSeed[slab] = seed;
+    if ((mGroupAnchorIdx != UINT8_MAX) && ((mGroupAnchorIdx / ACTION_SCHEDULER_SLAB_NODES) == slab))
+    {
+        mGroupAnchorIdx = UINT8_MAX;
+    }
+    __atomic_store_n(&mSlabs[slab], (ActionNode_t*)NULL, __ATOMIC_RELAXED);
+    mPool->releaseSlab(nodes);
+}
+#endif
+
+uint16_t ActionSchedulerCore::generateActionIdAt(uint8_t idx) {
+    return idx | ((uint16_t)nodeAt(idx).usedCounter << 8);
+}
+
+bool ActionSchedulerCore::isNodeLinked(uint8_t idx) {
+    return nodeAt(idx).state == ACTION_NODE_TIMELINE;
+}
+
+void ActionSchedulerCore::releaseNodeAt(uint8_t idx) {
+#if ACTION_SCHEDULER_UNIQUE_BUCKETS > 0
+    if ((nodeAt(idx).flags & ACTION_NODE_FLAG_UNIQUE) != 0U)
+    {
+        removeUniqueNode(idx);
+    }
+#endif
+#if ACTION_SCHEDULER_GROUPS > 0
+    if (nodeAt(idx).group != 0U)
+    {
+        unlinkGroupNodeAt(idx);
+    }
+#endif
+#if ACTION_SCHEDULER_RESERVE_CLASSES > 0
+    returnSlot(nodeAt(idx).reserveClass);
+#endif
+    nodeAt(idx).callback = NULL;
+    nodeAt(idx).state = ACTION_NODE_FREE;
+#if ACTION_SCHEDULER_ENABLE_NODE_POOL
+    uint8_t slab = idx / ACTION_SCHEDULER_SLAB_NODES;
+    mSlabUsed[slab]--;
+    if ((mSlabUsed[slab] == 0U) && (mPool != NULL))
+    {
+        // nothing left in this slab, let another scheduler have it
+        detachSlab(slab);
+    }
+#endif
+}
+
+void ActionSchedulerCore::removeNodeAt(uint8_t idx) {
+    if(idx < mCapacity)
+    {
+        switch(nodeAt(idx).state)
+        {
+            case ACTION_NODE_TIMELINE:
+                unlinkNodeAt(idx);
+                releaseNodeAt(idx);
+                break;
+            case ACTION_NODE_READY:
+                unlinkReadyNodeAt(idx);
+                releaseNodeAt(idx);
+                break;
+            case ACTION_NODE_PARKED:
+                unparkNodeAt(idx);
+                releaseNodeAt(idx);
+                break;
+            case ACTION_NODE_SUSPENDED:
+                releaseNodeAt(idx);
+                break;
+            case ACTION_NODE_RUNNING:
+                // The callback is being executed, mark it cancelled so it won't be reloaded
+                // The slot is released by proceed() once the callback returns
+#if ACTION_SCHEDULER_UNIQUE_BUCKETS > 0
+                if ((nodeAt(idx).flags & ACTION_NODE_FLAG_UNIQUE) != 0U)
                 {
-                    // this is not the start node nor the end node, but its next and previous are itself
-                    // means this is an isolated node not in the timeline
-                    return;
+                    removeUniqueNode(idx); // the bucket is hashed from the callback
                 }
-                uint8_t previousCursor = mNodes[idx].previousNodeIdx;
-                uint8_t nextCursor = mNodes[idx].nextNodeIdx;
-                mNodes[previousCursor].nextNodeIdx = nextCursor;
-                mNodes[nextCursor].previousNodeIdx = previousCursor;
-                mNodes[nextCursor].delayToPrevious += mNodes[idx].delayToPrevious;
-                mActiveNodes -= 1U;
-            }
+#endif
+                nodeAt(idx).callback = NULL;
+                break;
+            default:
+                // Nothing
+                break;
         }
-        else if (mActiveNodes == 1U)
+    }
+}
+
+void ActionSchedulerCore::unlinkNodeAt(uint8_t idx) {
+    if (mActiveNodes > 1U)
+    {
+        if (idx == mNodeStartIdx)
         {
-            if(idx != mNodeStartIdx)
-            {
-                // This is an isolated node
-                return;
-            }
-            //only the head node
-            mActiveNodes = 0;
-            mNodeStartIdx = idx;
-            mNodeEndIdx = idx;
+            uint8_t nextCursor = nodeAt(idx).nextNodeIdx;
+            nodeAt(nextCursor).previousNodeIdx = nextCursor;
+            mActiveNodes -= 1U;
+            uint32_t timeleft = nodeAt(mNodeStartIdx).delayToPrevious;
+            mNodeStartIdx = nextCursor;
+            nodeAt(mNodeStartIdx).delayToPrevious += timeleft;
+        }
+        else if (idx == mNodeEndIdx)
+        {
+            uint8_t previousCursor = nodeAt(idx).previousNodeIdx;
+            nodeAt(previousCursor).nextNodeIdx = previousCursor;
+            mNodeEndIdx = previousCursor;
+            mActiveNodes -= 1U;
         }
+        else
+        {
+            uint8_t previousCursor = nodeAt(idx).previousNodeIdx;
+            uint8_t nextCursor = nodeAt(idx).nextNodeIdx;
+            nodeAt(previousCursor).nextNodeIdx = nextCursor;
+            nodeAt(nextCursor).previousNodeIdx = previousCursor;
+            nodeAt(nextCursor).delayToPrevious += nodeAt(idx).delayToPrevious;
+            mActiveNodes -= 1U;
+        }
+    }
+    else if (mActiveNodes == 1U)
+    {
+        //only the head node
+        mActiveNodes = 0;
+        mNodeStartIdx = idx;
+        mNodeEndIdx = idx;
     }
 }
 
-void ActionScheduler::insertNode(uint8_t idx, uint32_t delay) {
+void ActionSchedulerCore::insertNode(uint8_t idx, uint32_t delay) {
     int16_t idxA = -1, idxB = (int16_t)mNodeStartIdx;
     //find the correct location for the new node in the linked list, starting from first node
-    while (mNodes[idxB].delayToPrevious <= delay)
+#if ACTION_SCHEDULER_STABLE_ORDER
+    // go past the nodes with the same deadline, so the new node is the last of them (FIFO)
+    while (nodeAt(idxB).delayToPrevious <= delay)
+#else
+    // stop at the first node with the same deadline, the new node is placed in front of it
+    while (nodeAt(idxB).delayToPrevious < delay)
+#endif
     {
-        delay = delay - mNodes[idxB].delayToPrevious;
+        delay = delay - nodeAt(idxB).delayToPrevious;
         idxA = idxB;
         if (idxB == (int16_t)mNodeEndIdx) //end
         {
@@ -114,266 +403,1860 @@ void ActionScheduler::insertNode(uint8_t idx, uint32_t delay) {
         }
         else
         {
-            idxB = (int16_t)mNodes[idxB].nextNodeIdx;
+            idxB = (int16_t)nodeAt(idxB).nextNodeIdx;
         }
     }
-    mNodes[idx].delayToPrevious = delay;
+    nodeAt(idx).delayToPrevious = delay;
     // Insert node
     if (idxA < 0)
     {
         //this means node should be inserted only before idxB, and in this situation idxB is the old start
-        mNodes[idx].previousNodeIdx = idx;
-        mNodes[idx].nextNodeIdx = (uint8_t)idxB;
-        mNodes[idxB].previousNodeIdx = idx;
-        mNodes[idxB].delayToPrevious = mNodes[idxB].delayToPrevious - mNodes[idx].delayToPrevious;
+        nodeAt(idx).previousNodeIdx = idx;
+        nodeAt(idx).nextNodeIdx = (uint8_t)idxB;
+        nodeAt(idxB).previousNodeIdx = idx;
+        nodeAt(idxB).delayToPrevious = nodeAt(idxB).delayToPrevious - nodeAt(idx).delayToPrevious;
         mNodeStartIdx = idx;
     }
     else if (idxB < 0)
     {
         //this means node should be inserted only after idxA, and in this situation idxA is the old end
-        mNodes[idx].previousNodeIdx = (uint8_t)idxA;
-        mNodes[idx].nextNodeIdx = idx; //set it to self as the end
-        mNodes[idxA].nextNodeIdx = idx;
+        nodeAt(idx).previousNodeIdx = (uint8_t)idxA;
+        nodeAt(idx).nextNodeIdx = idx; //set it to self as the end
+        nodeAt(idxA).nextNodeIdx = idx;
         mNodeEndIdx = idx;
     }
     else
     {
         //normal insertion between 2 nodes
-        mNodes[idx].previousNodeIdx = (uint8_t)idxA;
-        mNodes[idx].nextNodeIdx = (uint8_t)idxB;
-        mNodes[idxA].nextNodeIdx = idx;
-        mNodes[idxB].previousNodeIdx = idx;
-        mNodes[idxB].delayToPrevious -= mNodes[idx].delayToPrevious;
+        nodeAt(idx).previousNodeIdx = (uint8_t)idxA;
+        nodeAt(idx).nextNodeIdx = (uint8_t)idxB;
+        nodeAt(idxA).nextNodeIdx = idx;
+        nodeAt(idxB).previousNodeIdx = idx;
+        nodeAt(idxB).delayToPrevious -= nodeAt(idx).delayToPrevious;
     }
 }
 
-bool ActionScheduler::proceed(uint32_t timeElapsedMs) {
-    bool ret = false;
-    noInterrupts(); // Critical section begin
+void ActionSchedulerCore::setGroupAnchor(uint8_t idx, uint32_t delay) {
+    mGroupAnchorIdx = idx;
+    mGroupAnchorCounter = nodeAt(idx).usedCounter;
+    mGroupAnchorDeadline = mProceedingTime + delay;
+}
 
-    while ((timeElapsedMs >= mNodes[mNodeStartIdx].delayToPrevious) && (mActiveNodes > 0U))
+bool ActionSchedulerCore::insertNodeGrouped(uint8_t idx, uint32_t delay) {
+    uint8_t anchor = mGroupAnchorIdx;
+    // The anchor must still be the same action and still be in the timeline, and the deadline must match exactly
+    if ((anchor >= mCapacity) ||
+        (nodeAt(anchor).callback == NULL) ||
+        (nodeAt(anchor).usedCounter != mGroupAnchorCounter) ||
+        (mGroupAnchorDeadline != (mProceedingTime + delay)) ||
+        !isNodeLinked(anchor))
     {
-        timeElapsedMs -= mNodes[mNodeStartIdx].delayToPrevious;
-        mProceedingTime += mNodes[mNodeStartIdx].delayToPrevious;
-        uint8_t currentCursor = mNodeStartIdx;
-        mActiveNodes -= 1U;
-        ActionCallback_t cb = mNodes[currentCursor].callback;
-        void* arg = mNodes[currentCursor].arg;
-        if (mActiveNodes > 0U)
-        {
-            // isolate the node out from the timeline
-            uint8_t nextCursor = mNodes[currentCursor].nextNodeIdx;
-            mNodes[nextCursor].previousNodeIdx = nextCursor;
-            mNodeStartIdx = nextCursor;
-            mNodes[currentCursor].nextNodeIdx = currentCursor;
-        }
-        else
+        return false;
+    }
+#if ACTION_SCHEDULER_STABLE_ORDER
+    // Skip the nodes already grouped behind the anchor, so the new node is still the last one of its deadline
+    while ((anchor != mNodeEndIdx) && (nodeAt(nodeAt(anchor).nextNodeIdx).delayToPrevious == 0U))
+    {
+        anchor = nodeAt(anchor).nextNodeIdx;
+    }
+#endif
+    nodeAt(idx).delayToPrevious = 0U;
+    nodeAt(idx).previousNodeIdx = anchor;
+    if (anchor == mNodeEndIdx)
+    {
+        nodeAt(idx).nextNodeIdx = idx; //set it to self as the end
+        mNodeEndIdx = idx;
+    }
+    else
+    {
+        uint8_t nextCursor = nodeAt(anchor).nextNodeIdx;
+        nodeAt(idx).nextNodeIdx = nextCursor;
+        nodeAt(nextCursor).previousNodeIdx = idx;
+    }
+    nodeAt(anchor).nextNodeIdx = idx;
+    return true;
+}
+
+void ActionSchedulerCore::linkNode(uint8_t idx, uint32_t delay) {
+    if (freezeNodeAt(idx, delay))
+    {
+        return;
+    }
+    if (mActiveNodes == 0U) //the linked list is empty, this is the first node
+    {
+        nodeAt(idx).delayToPrevious = delay;
+        nodeAt(idx).previousNodeIdx = idx;
+        nodeAt(idx).nextNodeIdx = idx; //set it to self as the end
+        mNodeStartIdx = idx;
+        mNodeEndIdx = idx;
+    }
+    else if (!insertNodeGrouped(idx, delay))
+    {
+        insertNode(idx, delay);
+    }
+    nodeAt(idx).state = ACTION_NODE_TIMELINE;
+    mActiveNodes += 1U;
+    setGroupAnchor(idx, delay);
+}
+
+uint32_t ActionSchedulerCore::readyKeyAt(uint8_t idx) {
+    // While a node is out of the timeline, delayToPrevious holds its deadline (in proceeding time)
+#if ACTION_SCHEDULER_ENABLE_DEADLINES
+    return nodeAt(idx).delayToPrevious + nodeAt(idx).completionDeadline;
+#else
+    return nodeAt(idx).delayToPrevious;
+#endif
+}
+
+void ActionSchedulerCore::pushReadyNode(uint8_t idx) {
+    // a reload due again straight away, its group may have been suspended from the callback
+    int32_t remaining = (int32_t)(nodeAt(idx).delayToPrevious - mProceedingTime);
+    if (freezeNodeAt(idx, (remaining > 0) ? (uint32_t)remaining : 0U))
+    {
+        return;
+    }
+    uint8_t level = levelAt(idx);
+    uint8_t cursor = mReadyTail[level];
+    uint32_t key = readyKeyAt(idx);
+    // Walk back from the tail to keep the deadline order, the nodes mostly come in order so this is normally O(1)
+    // Only strictly later deadlines are passed, so equal deadlines stay FIFO
+    while ((cursor != UINT8_MAX) && ((int32_t)(readyKeyAt(cursor) - key) > 0))
+    {
+        cursor = (cursor == mReadyHead[level]) ? UINT8_MAX : nodeAt(cursor).previousNodeIdx;
+    }
+    if (cursor == UINT8_MAX)
+    {
+        if (mReadyHead[level] == UINT8_MAX)
         {
-            mNodes[currentCursor].nextNodeIdx = currentCursor;
+            //the queue is empty
+            nodeAt(idx).previousNodeIdx = idx;
+            nodeAt(idx).nextNodeIdx = idx;
+            mReadyTail[level] = idx;
         }
-        // This whole function should be inside the lock, but here we need to unlock for the callback chain
-        interrupts(); // Allow interrupts during callback
-        ActionReturn_t actionRet = cb(arg);
-        noInterrupts(); // Re-enter critical section
-        switch(actionRet)
+        else
         {
-            case ACTION_ONESHOT:
-                mNodes[currentCursor].callback = NULL;
-                break;
-            case ACTION_RELOAD:
-                // The callback can unschedule this, result in callback changed to null, we need to check this
-                if(mNodes[currentCursor].callback != NULL)
-                {
-                    if (mActiveNodes == 0U) //the linked list is empty, this is the first node
-                    {
-                        mNodes[currentCursor].delayToPrevious = mNodes[currentCursor].reload;
-                    }
-                    else
-                    {
-                        insertNode(currentCursor, mNodes[currentCursor].reload);
-                    }
-                    mActiveNodes++;
-                }
-                break;
-            default:
-                // Nothing
-                break;
+            //insert before the old head
+            uint8_t nextCursor = mReadyHead[level];
+            nodeAt(idx).previousNodeIdx = idx;
+            nodeAt(idx).nextNodeIdx = nextCursor;
+            nodeAt(nextCursor).previousNodeIdx = idx;
         }
-        ret = true;
+        mReadyHead[level] = idx;
     }
-
-    if (mActiveNodes > 0U)
+    else if (cursor == mReadyTail[level])
     {
-        mNodes[mNodeStartIdx].delayToPrevious -= timeElapsedMs;
-        mProceedingTime += timeElapsedMs;
+        nodeAt(idx).previousNodeIdx = cursor;
+        nodeAt(idx).nextNodeIdx = idx; //set it to self as the end
+        nodeAt(cursor).nextNodeIdx = idx;
+        mReadyTail[level] = idx;
     }
-    
-    interrupts(); // Critical section end
-    return ret;
+    else
+    {
+        uint8_t nextCursor = nodeAt(cursor).nextNodeIdx;
+        nodeAt(idx).previousNodeIdx = cursor;
+        nodeAt(idx).nextNodeIdx = nextCursor;
+        nodeAt(cursor).nextNodeIdx = idx;
+        nodeAt(nextCursor).previousNodeIdx = idx;
+    }
+    nodeAt(idx).state = ACTION_NODE_READY;
+    mReadyMask |= (uint8_t)(1U << level);
 }
 
-ActionSchedulerId_t ActionScheduler::scheduleReload(uint32_t delayedTime, uint32_t reload, ActionCallback_t cb, void* arg) {
-    uint16_t ActionSchedulerId = ACTION_SCHEDULER_ID_INVALID;
-    if ((cb == NULL) || (mActiveNodes >= ACTION_SCHEDULER_MAX_NODES))
+void ActionSchedulerCore::unlinkReadyNodeAt(uint8_t idx) {
+    uint8_t level = levelAt(idx);
+    if ((idx == mReadyHead[level]) && (idx == mReadyTail[level]))
     {
-        return ActionSchedulerId;
+        mReadyHead[level] = UINT8_MAX;
+        mReadyTail[level] = UINT8_MAX;
+        mReadyMask &= (uint8_t)~(1U << level);
     }
-    
-    noInterrupts(); // Critical section begin
-    
-    if (mActiveNodes == 0U) //the linked list is empty, this is the first node
+    else if (idx == mReadyHead[level])
     {
-        uint8_t freeCursor = mNodeStartIdx;
-        if(!getFreeSlot(&freeCursor))
-        {
-            interrupts();
-            return ACTION_SCHEDULER_ID_INVALID;
-        }
-        mNodes[freeCursor].usedCounter++;
-        mNodes[freeCursor].previousNodeIdx = freeCursor;
-        mNodes[freeCursor].nextNodeIdx = freeCursor; //set it to self as the end
-        mNodes[freeCursor].delayToPrevious = delayedTime;
-        mNodes[freeCursor].callback = cb;
-        mNodes[freeCursor].arg = arg;
-        mNodes[freeCursor].reload = reload;
-        mNodeStartIdx = freeCursor;
-        mNodeEndIdx = freeCursor;
-        mActiveNodes += 1U;
-        ActionSchedulerId = generateActionIdAt(freeCursor);
+        uint8_t nextCursor = nodeAt(idx).nextNodeIdx;
+        nodeAt(nextCursor).previousNodeIdx = nextCursor;
+        mReadyHead[level] = nextCursor;
+    }
+    else if (idx == mReadyTail[level])
+    {
+        uint8_t previousCursor = nodeAt(idx).previousNodeIdx;
+        nodeAt(previousCursor).nextNodeIdx = previousCursor;
+        mReadyTail[level] = previousCursor;
     }
     else
     {
-        uint8_t freeCursor = mNodeEndIdx;
-        if(!getFreeSlot(&freeCursor))
-        {
-            interrupts();
-            return ACTION_SCHEDULER_ID_INVALID;
-        }
+        uint8_t previousCursor = nodeAt(idx).previousNodeIdx;
+        uint8_t nextCursor = nodeAt(idx).nextNodeIdx;
+        nodeAt(previousCursor).nextNodeIdx = nextCursor;
+        nodeAt(nextCursor).previousNodeIdx = previousCursor;
+    }
+}
 
-        mNodes[freeCursor].usedCounter++;
-        mNodes[freeCursor].callback = cb;
-        mNodes[freeCursor].arg = arg;
-        mNodes[freeCursor].delayToPrevious = delayedTime;
-        mNodes[freeCursor].reload = reload;
-        mActiveNodes += 1U;
+bool ActionSchedulerCore::popReadyNode(uint8_t* idx) {
+    if (mReadyMask == 0U)
+    {
+        return false;
+    }
+    uint8_t level = ACTION_SCHEDULER_PRIORITY_LEVELS - 1U;
+    while ((mReadyMask & (uint8_t)(1U << level)) == 0U)
+    {
+        level--;
+    }
+    *idx = mReadyHead[level];
+    unlinkReadyNodeAt(*idx);
+    return true;
+}
 
-        insertNode(freeCursor, delayedTime);
-        ActionSchedulerId = generateActionIdAt(freeCursor);
+void ActionSchedulerCore::queueDueNodes(uint32_t ticksElapsed) {
+    while ((mActiveNodes > 0U) && (nodeAt(mNodeStartIdx).delayToPrevious <= ticksElapsed))
+    {
+        uint8_t currentCursor = mNodeStartIdx;
+        uint32_t deadline = mProceedingTime + nodeAt(currentCursor).delayToPrevious;
+        // the delay is handed to the next node, which keeps it relative to the proceeding time
+        unlinkNodeAt(currentCursor);
+        nodeAt(currentCursor).delayToPrevious = deadline;
+        pushReadyNode(currentCursor);
     }
-    
-    interrupts(); // Critical section end
-    
-    if(mActiveNodes > mActiveNodesWaterMark)
+}
+
+void ActionSchedulerCore::collectDueNodes(uint32_t* ticksElapsed) {
+    if ((mParkedHead != UINT8_MAX) && ((int32_t)(mProceedingTime + *ticksElapsed - mHorizonCheck) >= 0))
     {
-        mActiveNodesWaterMark = mActiveNodes;
+        unparkDueNodes();
     }
+    // Every node due by the end of the elapsed time is queued, so the priorities are compared across all of them
+    queueDueNodes(*ticksElapsed);
+    if (mReadyMask == 0U)
+    {
+        // Nothing is due anymore within the elapsed time, the rest of it is consumed at once
+        advanceTime(*ticksElapsed);
+        *ticksElapsed = 0U;
+        // A drain window also takes the nodes due shortly after, they run early instead of costing another wakeup
+        queueDueNodes(mCollectWindow);
+    }
+}
 
-    return ActionSchedulerId;
+void ActionSchedulerCore::advanceTime(uint32_t ticks) {
+    // the timeline head is never due within the elapsed time left, so its delay covers the ticks
+    if (mActiveNodes > 0U)
+    {
+        nodeAt(mNodeStartIdx).delayToPrevious -= ticks;
+    }
+    uint32_t startTime = mProceedingTime;
+    mProceedingTime += ticks;
+    if (mProceedingTime < startTime)
+    {
+        mProceedingEpoch++;
+    }
 }
 
-ActionSchedulerId_t ActionScheduler::schedule(uint32_t delayedTime, ActionCallback_t cb, void* arg) {
-    return scheduleReload(delayedTime, delayedTime, cb, arg);
+uint64_t ActionSchedulerCore::getNow64() {
+    return ((uint64_t)mProceedingEpoch << 32) | mProceedingTime;
 }
 
-bool ActionScheduler::unschedule(ActionSchedulerId_t* actionId) {
-    bool ret = false;
-    if (*actionId != ACTION_SCHEDULER_ID_INVALID)
+void ActionSchedulerCore::parkNodeAt(uint8_t idx, uint64_t deadline) {
+    if (mParkedHead == UINT8_MAX)
     {
-        noInterrupts(); // Critical section begin
-        uint8_t id = (uint8_t)(*actionId & 0xffU);
-        uint8_t counter = (uint8_t)(*actionId >> 8U);
-        if ((id < ACTION_SCHEDULER_MAX_NODES) && (mNodes[id].callback != NULL) && (mNodes[id].usedCounter == counter))
+        nodeAt(idx).nextNodeIdx = idx; //set it to self as the end
+        mHorizonCheck = mProceedingTime + (ACTION_SCHEDULER_HORIZON / 2U);
+    }
+    else
+    {
+        nodeAt(idx).nextNodeIdx = mParkedHead;
+        nodeAt(mParkedHead).previousNodeIdx = idx;
+    }
+    nodeAt(idx).previousNodeIdx = idx;
+    mParkedHead = idx;
+    nodeAt(idx).delayToPrevious = (uint32_t)deadline;
+    nodeAt(idx).reload = (uint32_t)(deadline >> 32);
+    nodeAt(idx).state = ACTION_NODE_PARKED;
+}
+
+void ActionSchedulerCore::unparkNodeAt(uint8_t idx) {
+    uint8_t previousCursor = nodeAt(idx).previousNodeIdx;
+    uint8_t nextCursor = nodeAt(idx).nextNodeIdx;
+    if (previousCursor == idx)
+    {
+        mParkedHead = (nextCursor == idx) ? UINT8_MAX : nextCursor;
+        if (nextCursor != idx)
         {
-            ret = true;
-            removeNodeAt(id);
-            *actionId = ACTION_SCHEDULER_ID_INVALID;
+            nodeAt(nextCursor).previousNodeIdx = nextCursor;
+        }
+    }
+    else
+    {
+        nodeAt(previousCursor).nextNodeIdx = (nextCursor == idx) ? previousCursor : nextCursor;
+        if (nextCursor != idx)
+        {
+            nodeAt(nextCursor).previousNodeIdx = previousCursor;
         }
-        interrupts(); // Critical section end
     }
-    return ret;
 }
 
-bool ActionScheduler::unscheduleAll(ActionCallback_t cb) {
-    bool ret = false;
-    noInterrupts(); // Critical section begin
-    uint8_t currentCursor = mNodeStartIdx;
-    uint8_t nextCursor = currentCursor;
-    bool isEnd;
-    do {
-        currentCursor = nextCursor;
-        nextCursor = mNodes[currentCursor].nextNodeIdx;
-        isEnd = currentCursor == mNodeEndIdx;
-        if (mNodes[currentCursor].callback == cb)
+void ActionSchedulerCore::unparkDueNodes() {
+    // Scanned every half horizon, so a node is moved while it is still at least that far away
+    uint64_t now = getNow64();
+    uint8_t cursor = mParkedHead;
+    while (cursor != UINT8_MAX)
+    {
+        uint8_t nextCursor = (nodeAt(cursor).nextNodeIdx == cursor) ? UINT8_MAX : nodeAt(cursor).nextNodeIdx;
+        uint64_t deadline = ((uint64_t)nodeAt(cursor).reload << 32) | nodeAt(cursor).delayToPrevious;
+        uint64_t remaining = (deadline > now) ? (deadline - now) : 0U;
+        if (remaining < ACTION_SCHEDULER_HORIZON)
         {
-            ret = true;
-            removeNodeAt(currentCursor);
+            unparkNodeAt(cursor);
+            nodeAt(cursor).reload = 0U;
+            linkNode(cursor, (uint32_t)remaining);
+            if(mActiveNodes > mActiveNodesWaterMark)
+            {
+                mActiveNodesWaterMark = mActiveNodes;
+            }
         }
-    } while (!isEnd);
-    interrupts(); // Critical section end
-    return ret;
+        cursor = nextCursor;
+    }
+    mHorizonCheck = mProceedingTime + (ACTION_SCHEDULER_HORIZON / 2U);
 }
 
-void ActionScheduler::clear() {
-    noInterrupts(); // Critical section begin
-    for (uint16_t i = 0; i < ACTION_SCHEDULER_MAX_NODES; i++)
+void ActionSchedulerCore::startRunAt(uint8_t idx, uint32_t ticksPending) {
+    // A running node holds its deadline, a fixed-delay node keeps the drift of its earlier runs
+    // It starts at the end of the elapsed time, the proceeding time only sits at its release until the pass is done
+    uint32_t now = mProceedingTime + ticksPending;
+#if ACTION_SCHEDULER_ENABLE_PHASE_ERROR
+    uint32_t lateness = now - nodeAt(idx).delayToPrevious;
+    if ((nodeAt(idx).flags & ACTION_NODE_FLAG_FIXED_DELAY) != 0U)
     {
-        mNodes[i].usedCounter = 0U;
-        mNodes[i].arg = NULL;
-        mNodes[i].callback = NULL;
-        mNodes[i].delayToPrevious = 0U;
-        mNodes[i].reload = 0U;
-        mNodes[i].nextNodeIdx = 0U;
-        mNodes[i].previousNodeIdx = 0U;
+        nodeAt(idx).phaseError += lateness;
+    }
+    else
+    {
+        nodeAt(idx).phaseError = ((int32_t)lateness > 0) ? lateness : 0U;
+    }
+#endif
+    if ((nodeAt(idx).flags & ACTION_NODE_FLAG_FIXED_DELAY) != 0U)
+    {
+        // the deadline is of no use anymore, the next one counts from the start of this run
+        nodeAt(idx).delayToPrevious = now;
     }
-    mNodeStartIdx = 0;
-    mNodeEndIdx = 0;
-    mActiveNodes = 0;
-    mProceedingTime = 0;
-    interrupts(); // Critical section end
 }
 
-uint32_t ActionScheduler::getNextEventDelay() {
-    if(mActiveNodes > 0U)
+void ActionSchedulerCore::reloadNodeAt(uint8_t idx, uint32_t runTime) {
+    uint32_t reload = nodeAt(idx).reload;
+#if ACTION_SCHEDULER_ENABLE_FRACTIONAL_RELOAD
+    if (nodeAt(idx).reloadNum != 0U)
+    {
+        // one more tick each time the carried fraction makes a whole one
+        uint16_t acc = (uint16_t)(nodeAt(idx).reloadAcc + nodeAt(idx).reloadNum);
+        if (acc >= nodeAt(idx).reloadDen)
+        {
+            acc = (uint16_t)(acc - nodeAt(idx).reloadDen);
+            reload++;
+        }
+        nodeAt(idx).reloadAcc = (uint8_t)acc;
+    }
+#endif
+    if ((nodeAt(idx).flags & ACTION_NODE_FLAG_FIXED_DELAY) != 0U)
+    {
+        // Relative to the completion: the start plus the run time measured by the clock (a callback within proceed),
+        // or the proceeding time if it has gone past that meanwhile (a job on an executor)
+        uint32_t completion = nodeAt(idx).delayToPrevious + runTime;
+        if ((int32_t)(mProceedingTime - completion) > 0)
+        {
+            completion = mProceedingTime;
+        }
+#if ACTION_SCHEDULER_ENABLE_PHASE_ERROR
+        nodeAt(idx).phaseError += completion - nodeAt(idx).delayToPrevious;
+#endif
+        linkNode(idx, reload + (completion - mProceedingTime));
+        return;
+    }
+    (void)runTime;
+    // The reload is relative to the deadline the node was due at, not to when it was executed
+    uint32_t lateness = mProceedingTime - nodeAt(idx).delayToPrevious;
+    // a node run early from a drain window is "negatively late", its next run is a bit more than a period away
+    if (((int32_t)lateness < 0) || (reload > lateness))
+    {
+        linkNode(idx, reload - lateness);
+    }
+    else
     {
-        return mNodes[mNodeStartIdx].delayToPrevious;
+        // The next period is already due as well, queue it again straight away
+        // but behind the nodes its callback or an ISR scheduled with no delay meanwhile, they came first
+        queueDueNodes(0U);
+        nodeAt(idx).delayToPrevious += reload;
+        pushReadyNode(idx);
     }
-    return UINT32_MAX;
 }
 
-uint32_t ActionScheduler::getProceedingTime() {
-    return mProceedingTime;
+bool ActionSchedulerCore::proceed(uint32_t ticksElapsed) {
+    return runPass(ticksElapsed, 0U);
 }
 
-void ActionScheduler::clearProceedingTime() {
-    mProceedingTime = 0;
+uint32_t ActionSchedulerCore::proceedWindow(uint32_t ticksElapsed, uint32_t window) {
+    (void)runPass(ticksElapsed, window);
+    return getNextEventDelay();
 }
 
-bool ActionScheduler::isCallbackArmed(ActionCallback_t cb) {
-    noInterrupts(); // Critical section begin
+bool ActionSchedulerCore::runPass(uint32_t ticksElapsed, uint32_t window) {
     bool ret = false;
-    
-    if (mActiveNodes > 0U && mNodes[mNodeStartIdx].callback == cb)
-    {
-        ret = true;
-    }
-    else
+#if ACTION_SCHEDULER_POST_QUEUE_SIZE > 0
+    drainPostQueue();
+#endif
+    enterCriticalSection(); // Critical section begin
+    mCollectWindow = window;
+
+#if ACTION_SCHEDULER_ENABLE_SPILL
+    mergeSpill();
+#endif
+    collectDueNodes(&ticksElapsed);
+
+    uint8_t currentCursor;
+    while (popReadyNode(&currentCursor))
     {
-        for (uint8_t i = (mNodeStartIdx + 1U) % ACTION_SCHEDULER_MAX_NODES; 
-             i != mNodeStartIdx; 
-             i = (i + 1U) % ACTION_SCHEDULER_MAX_NODES)
+        ActionCallback_t cb = nodeAt(currentCursor).callback;
+        void* arg = nodeAt(currentCursor).arg;
+        uint8_t usedCounter = nodeAt(currentCursor).usedCounter;
+        nodeAt(currentCursor).state = ACTION_NODE_RUNNING;
+        // The proceeding time catches up with the release of the node, so it is the base of what its callback schedules
+        // It never goes back for an earlier release picked after a higher priority one, nor past the elapsed time
+        int32_t ahead = (int32_t)(nodeAt(currentCursor).delayToPrevious - mProceedingTime);
+        if (ahead > 0)
+        {
+            uint32_t step = ((uint32_t)ahead < ticksElapsed) ? (uint32_t)ahead : ticksElapsed;
+            advanceTime(step);
+            ticksElapsed -= step;
+        }
+#if ACTION_SCHEDULER_ENABLE_EXECUTOR
+        if (mExecutor != NULL)
+        {
+            ActionJob_t job;
+            job.id = generateActionIdAt(currentCursor);
+            job.callback = cb;
+            job.arg = arg;
+            job.affinity = nodeAt(currentCursor).affinity;
+            startRunAt(currentCursor, ticksElapsed);
+            ActionExecutor_t executor = mExecutor;
+            void* context = mExecutorContext;
+            exitCriticalSection(); // The executor may block on its own queue
+            executor(context, job);
+            enterCriticalSection();
+            collectDueNodes(&ticksElapsed);
+            ret = true;
+            continue;
+        }
+#endif
+#if ACTION_SCHEDULER_ENABLE_DEADLINES
+        bool hasDeadline = nodeAt(currentCursor).completionDeadline != 0U;
+        // how far the completion deadline is ahead of now, negative when it is already missed
+        // now is the end of the elapsed time, the proceeding time only sits at the release of the node
+        int32_t slack = (int32_t)(readyKeyAt(currentCursor) - (mProceedingTime + ticksElapsed));
+        ActionSchedulerClock_t clock = mClock;
+        uint32_t startTime = (hasDeadline && (clock != NULL)) ? clock() : 0U;
+#endif
+        ActionSchedulerClock_t runClock = ((nodeAt(currentCursor).flags & ACTION_NODE_FLAG_FIXED_DELAY) != 0U) ? mClock : NULL;
+        uint32_t runStart = (runClock != NULL) ? runClock() : 0U;
+        startRunAt(currentCursor, ticksElapsed);
+        // This whole function should be inside the lock, but here we need to unlock for the callback chain
+        exitCriticalSection(); // Allow interrupts during callback
+        ActionReturn_t actionRet = cb(arg);
+        uint32_t runTime = (runClock != NULL) ? (runClock() - runStart) : 0U;
+#if ACTION_SCHEDULER_ENABLE_DEADLINES
+        if (hasDeadline)
         {
-            if (mNodes[i].callback == cb)
+            int32_t overrun = -slack;
+            if (clock != NULL)
             {
-                ret = true;
-                break;
+                overrun += (int32_t)(clock() - startTime);
+            }
+            if (overrun > 0)
+            {
+                ActionDeadlineMissHook_t hook = mDeadlineMissHook;
+                if (hook != NULL)
+                {
+                    hook((ActionSchedulerId_t)(currentCursor | ((uint16_t)usedCounter << 8)), cb, arg, (uint32_t)overrun);
+                }
+                enterCriticalSection();
+                mDeadlineMissCount++;
+                exitCriticalSection();
             }
         }
-    }
+#endif
+        enterCriticalSection(); // Re-enter critical section
+        // A clear() from the callback hands the slot back already, then it is not ours to touch
+        if (hasNodeAt(currentCursor) && (nodeAt(currentCursor).state == ACTION_NODE_RUNNING) && (nodeAt(currentCursor).usedCounter == usedCounter))
+        {
+            switch(actionRet)
+            {
+                case ACTION_RELOAD:
+                    // The callback can unschedule this, result in callback changed to null, we need to check this
+                    if((nodeAt(currentCursor).callback != NULL) && ((nodeAt(currentCursor).flags & ACTION_NODE_FLAG_ONESHOT) == 0U))
+                    {
+                        reloadNodeAt(currentCursor, runTime);
+                    }
+                    else
+                    {
+                        releaseNodeAt(currentCursor);
+                    }
+                    break;
+                default:
+                    releaseNodeAt(currentCursor);
+                    break;
+            }
+        }
+#if ACTION_SCHEDULER_ENABLE_SPILL
+        mergeSpill(); // a node may have been freed
+#endif
+        // The callback or an ISR can schedule actions due within the elapsed time left, they join the ready queues
+        collectDueNodes(&ticksElapsed);
+        ret = true;
+    }
+
+    mCollectWindow = 0U;
+    exitCriticalSection(); // Critical section end
+    return ret;
+}
+
+ActionSchedulerId_t ActionSchedulerCore::scheduleReload(uint32_t delayedTime, uint32_t reload, ActionCallback_t cb, void* arg) {
+    ActionOptions_t options = {};
+    return scheduleReload(delayedTime, reload, cb, arg, options);
+}
+
+ActionSchedulerId_t ActionSchedulerCore::scheduleReload(uint32_t delayedTime, uint32_t reload, ActionCallback_t cb, void* arg, const ActionOptions_t& options) {
+    return scheduleNode(delayedTime, reload, cb, arg, options, NULL, 0U);
+}
+
+#if ACTION_SCHEDULER_ENABLE_FRACTIONAL_RELOAD
+ActionSchedulerId_t ActionSchedulerCore::scheduleReloadRational(uint32_t delayedTime, uint32_t periodNum, uint8_t periodDen, ActionCallback_t cb, void* arg) {
+    ActionOptions_t options = {};
+    return scheduleReloadRational(delayedTime, periodNum, periodDen, cb, arg, options);
+}
+
+ActionSchedulerId_t ActionSchedulerCore::scheduleReloadRational(uint32_t delayedTime, uint32_t periodNum, uint8_t periodDen, ActionCallback_t cb, void* arg, const ActionOptions_t& options) {
+    uint16_t ActionSchedulerId = ACTION_SCHEDULER_ID_INVALID;
+    if ((cb == NULL) || (periodDen == 0U))
+    {
+        return ActionSchedulerId;
+    }
+
+    uint32_t reload = periodNum / periodDen;
+    enterCriticalSection(); // Critical section begin
+    ActionSchedulerId = createOrOverflow(delayedTime, reload, cb, arg, options, NULL, 0U, 0U);
+    if (ActionSchedulerId < ACTION_SCHEDULER_ID_SPILLED)
+    {
+        // set before the lock is released, the first re-arm already carries the fraction
+        uint8_t id = (uint8_t)(ActionSchedulerId & 0xffU);
+        nodeAt(id).reloadNum = (uint8_t)(periodNum % periodDen);
+        nodeAt(id).reloadDen = periodDen;
+    }
+    exitCriticalSection(); // Critical section end
+
+    return ActionSchedulerId;
+}
+#endif
+
+#if ACTION_SCHEDULER_INLINE_ARG_SIZE > 0
+ActionSchedulerId_t ActionSchedulerCore::scheduleCopy(uint32_t delayedTime, uint32_t reload, ActionCallback_t cb, const void* inlineArg, uint8_t inlineSize) {
+    ActionOptions_t options = {};
+    return scheduleNode(delayedTime, reload, cb, NULL, options, inlineArg, inlineSize);
+}
+#endif
+
+ActionSchedulerId_t ActionSchedulerCore::scheduleNode(uint32_t delayedTime, uint32_t reload, ActionCallback_t cb, void* arg, const ActionOptions_t& options, const void* inlineArg, uint8_t inlineSize) {
+    uint16_t ActionSchedulerId = ACTION_SCHEDULER_ID_INVALID;
+    if (cb == NULL)
+    {
+        return ActionSchedulerId;
+    }
     
-    interrupts(); // Critical section end
+    enterCriticalSection(); // Critical section begin
+    ActionSchedulerId = createOrOverflow(delayedTime, reload, cb, arg, options, inlineArg, inlineSize, 0U);
+    exitCriticalSection(); // Critical section end
+
+    return ActionSchedulerId;
+}
+
+ActionSchedulerId_t ActionSchedulerCore::createOrOverflow(uint32_t delayedTime, uint32_t reload, ActionCallback_t cb, void* arg, const ActionOptions_t& options, const void* inlineArg, uint8_t inlineSize, uint8_t flags) {
+    uint8_t freeCursor;
+    if (createNode(&freeCursor, delayedTime, reload, cb, arg, options, inlineArg, inlineSize))
+    {
+        nodeAt(freeCursor).flags |= flags;
+        return generateActionIdAt(freeCursor);
+    }
+    return handleOverflow(delayedTime, reload, cb, arg, options, inlineArg, inlineSize, flags);
+}
+
+ActionSchedulerId_t ActionSchedulerCore::scheduleAt(uint32_t deadline, ActionCallback_t cb, void* arg) {
+    uint16_t ActionSchedulerId = ACTION_SCHEDULER_ID_INVALID;
+    if (cb == NULL)
+    {
+        return ActionSchedulerId;
+    }
+
+    ActionOptions_t options = {};
+    enterCriticalSection(); // Critical section begin
+    // there is no period to reload with
+    ActionSchedulerId = createOrOverflow(getDelayUntil(deadline, 0U), 0U, cb, arg, options, NULL, 0U, ACTION_NODE_FLAG_ONESHOT);
+    exitCriticalSection(); // Critical section end
+
+    return ActionSchedulerId;
+}
+
+#if ACTION_SCHEDULER_HAS_COROUTINES
+ActionSchedulerId_t ActionSchedulerCore::scheduleResume(uint32_t delayedTime, ActionCallback_t cb, void* arg) {
+    ActionOptions_t options = {};
+    enterCriticalSection(); // Critical section begin
+    uint16_t ActionSchedulerId = createOrOverflow(delayedTime, 0U, cb, arg, options, NULL, 0U, ACTION_NODE_FLAG_ONESHOT | ACTION_NODE_FLAG_AWAITER);
+    exitCriticalSection(); // Critical section end
+
+    return ActionSchedulerId;
+}
+#endif
+
+ActionSchedulerId_t ActionSchedulerCore::scheduleReloadAt(uint32_t anchor, uint32_t reload, ActionCallback_t cb, void* arg) {
+    ActionOptions_t options = {};
+    return scheduleReloadAt(anchor, reload, cb, arg, options);
+}
+
+ActionSchedulerId_t ActionSchedulerCore::scheduleReloadAt(uint32_t anchor, uint32_t reload, ActionCallback_t cb, void* arg, const ActionOptions_t& options) {
+    uint16_t ActionSchedulerId = ACTION_SCHEDULER_ID_INVALID;
+    if (cb == NULL)
+    {
+        return ActionSchedulerId;
+    }
+
+    enterCriticalSection(); // Critical section begin
+    ActionSchedulerId = createOrOverflow(getDelayUntil(anchor, reload), reload, cb, arg, options, NULL, 0U, 0U);
+    exitCriticalSection(); // Critical section end
+
+    return ActionSchedulerId;
+}
+
+uint32_t ActionSchedulerCore::getDelayUntil(uint32_t deadline, uint32_t reload) {
+    // Within half the time range ahead is the future, anything else is the past
+    uint32_t late = mProceedingTime - deadline;
+    if ((int32_t)late <= 0)
+    {
+        return deadline - mProceedingTime;
+    }
+    if (reload == 0U)
+    {
+        return 0U;
+    }
+    // The next point of the anchor's grid, the periods already gone are skipped
+    uint32_t phase = late % reload;
+    return (phase == 0U) ? 0U : (reload - phase);
+}
+
+ActionSchedulerId_t ActionSchedulerCore::handleOverflow(uint32_t delayedTime, uint32_t reload, ActionCallback_t cb, void* arg, const ActionOptions_t& options, const void* inlineArg, uint8_t inlineSize, uint8_t flags) {
+#if ACTION_SCHEDULER_ENABLE_OVERFLOW_POLICY
+    switch(mOverflowPolicy)
+    {
+        case ACTION_OVERFLOW_EVICT_LATEST:
+        {
+            uint8_t victim = mNodeEndIdx;
+            bool evictable = (mActiveNodes > 0U) && (getRemainingTimeAt(victim) > delayedTime);
+            // nothing would resume or free the frame of an evicted coroutine
+            evictable = evictable && ((nodeAt(victim).flags & ACTION_NODE_FLAG_AWAITER) == 0U);
+#if ACTION_SCHEDULER_RESERVE_CLASSES > 0
+            // only a slot of the same class is sure to be handed to the new action
+            uint8_t reserveClass = (options.reserveClass < ACTION_SCHEDULER_RESERVE_CLASSES) ? options.reserveClass : 0U;
+            evictable = evictable && (nodeAt(victim).reserveClass == reserveClass);
+#endif
+            if (evictable)
+            {
+                removeNodeAt(victim);
+                mEvictedCount++;
+                uint8_t freeCursor;
+                if (createNode(&freeCursor, delayedTime, reload, cb, arg, options, inlineArg, inlineSize))
+                {
+                    nodeAt(freeCursor).flags |= flags;
+                    return generateActionIdAt(freeCursor);
+                }
+            }
+            break;
+        }
+#if ACTION_SCHEDULER_ENABLE_SPILL
+        case ACTION_OVERFLOW_SPILL:
+            // the inline payload lives in the node, there is nothing to keep it in meanwhile,
+            // and a suspended coroutine must not wait on a store that may never merge it back
+            if ((inlineArg == NULL) && ((flags & ACTION_NODE_FLAG_AWAITER) == 0U) && spillAction(delayedTime, reload, cb, arg, options, flags))
+            {
+                mSpilledCount++;
+                return ACTION_SCHEDULER_ID_SPILLED;
+            }
+            break;
+#endif
+        default:
+            // ACTION_OVERFLOW_REJECT
+            break;
+    }
+    mRejectedCount++;
+#else
+    (void)delayedTime;
+    (void)reload;
+    (void)cb;
+    (void)arg;
+    (void)options;
+    (void)inlineArg;
+    (void)flags;
+#endif
+    (void)inlineSize;
+    return ACTION_SCHEDULER_ID_INVALID;
+}
+
+#if ACTION_SCHEDULER_ENABLE_SPILL
+bool ActionSchedulerCore::spillAction(uint32_t delayedTime, uint32_t reload, ActionCallback_t cb, void* arg, const ActionOptions_t& options, uint8_t flags) {
+    if (mSpillCount >= mSpillCapacity)
+    {
+        if (mSpillCapacity >= (UINT16_MAX / 2U))
+        {
+            return false;
+        }
+        uint16_t capacity = (mSpillCapacity == 0U) ? 8U : (uint16_t)(mSpillCapacity * 2U);
+        ActionSpill_t* spill = (ActionSpill_t*)realloc(mSpill, capacity * sizeof(ActionSpill_t));
+        if (spill == NULL)
+        {
+            return false;
+        }
+        mSpill = spill;
+        mSpillCapacity = capacity;
+    }
+    uint32_t deadline = mProceedingTime + delayedTime;
+    // latest first, a new one goes in front of the equal deadlines so those spilled earlier merge back first
+    uint16_t pos = 0U;
+    while ((pos < mSpillCount) && ((int32_t)(mSpill[pos].deadline - deadline) > 0))
+    {
+        pos++;
+    }
+    memmove(&mSpill[pos + 1U], &mSpill[pos], (mSpillCount - pos) * sizeof(ActionSpill_t));
+    mSpill[pos].callback = cb;
+    mSpill[pos].arg = arg;
+    mSpill[pos].deadline = deadline;
+    mSpill[pos].reload = reload;
+    mSpill[pos].options = options;
+    mSpill[pos].flags = flags;
+    mSpillCount++;
+    return true;
+}
+
+void ActionSchedulerCore::mergeSpill() {
+    while (mSpillCount > 0U)
+    {
+        uint8_t freeCursor = mNodeEndIdx;
+        if (!getFreeSlot(&freeCursor))
+        {
+            break;
+        }
+        ActionSpill_t* spill = &mSpill[mSpillCount - 1U];
+        int32_t remaining = (int32_t)(spill->deadline - mProceedingTime);
+        if (!createNode(&freeCursor, (remaining > 0) ? (uint32_t)remaining : 0U, spill->reload, spill->callback, spill->arg, spill->options, NULL, 0U))
+        {
+            // the free slot is reserved by another class
+            break;
+        }
+        nodeAt(freeCursor).flags |= spill->flags;
+        mSpillCount--;
+    }
+}
+#endif
+
+bool ActionSchedulerCore::createNode(uint8_t* slotIdx, uint32_t delayedTime, uint32_t reload, ActionCallback_t cb, void* arg, const ActionOptions_t& options, const void* inlineArg, uint8_t inlineSize) {
+    if (!allocNode(slotIdx, reload, cb, arg, options, inlineArg, inlineSize))
+    {
+        return false;
+    }
+    linkNode(*slotIdx, delayedTime);
+    
+    if(mActiveNodes > mActiveNodesWaterMark)
+    {
+        mActiveNodesWaterMark = mActiveNodes;
+    }
+    return true;
+}
+
+bool ActionSchedulerCore::allocNode(uint8_t* slotIdx, uint32_t reload, ActionCallback_t cb, void* arg, const ActionOptions_t& options, const void* inlineArg, uint8_t inlineSize) {
+#if ACTION_SCHEDULER_RESERVE_CLASSES > 0
+    uint8_t reserveClass = (options.reserveClass < ACTION_SCHEDULER_RESERVE_CLASSES) ? options.reserveClass : 0U;
+    if (!reserveSlot(reserveClass))
+    {
+        return false;
+    }
+#endif
+    //find a free slot starting from the end, or from the start if the linked list is empty
+    uint8_t freeCursor = (mActiveNodes == 0U) ? mNodeStartIdx : mNodeEndIdx;
+    if(!getFreeSlot(&freeCursor))
+    {
+#if ACTION_SCHEDULER_RESERVE_CLASSES > 0
+        returnSlot(reserveClass);
+#endif
+        return false;
+    }
+#if ACTION_SCHEDULER_RESERVE_CLASSES > 0
+    nodeAt(freeCursor).reserveClass = reserveClass;
+#endif
+#if ACTION_SCHEDULER_ENABLE_NODE_POOL
+    mSlabUsed[freeCursor / ACTION_SCHEDULER_SLAB_NODES]++;
+#endif
+
+    nodeAt(freeCursor).usedCounter++;
+    nodeAt(freeCursor).callback = cb;
+    nodeAt(freeCursor).arg = arg;
+    nodeAt(freeCursor).flags = (options.reloadMode == ACTION_RELOAD_FIXED_DELAY) ? (uint8_t)ACTION_NODE_FLAG_FIXED_DELAY : 0U;
+#if ACTION_SCHEDULER_ENABLE_PHASE_ERROR
+    nodeAt(freeCursor).phaseError = 0U;
+#endif
+#if ACTION_SCHEDULER_INLINE_ARG_SIZE > 0
+    if (inlineArg != NULL)
+    {
+        // the payload is constructed in the slot, the callback gets a pointer to it
+        memcpy(nodeAt(freeCursor).inlineArg.bytes, inlineArg, inlineSize);
+        nodeAt(freeCursor).arg = nodeAt(freeCursor).inlineArg.bytes;
+    }
+#else
+    (void)inlineArg;
+    (void)inlineSize;
+#endif
+    nodeAt(freeCursor).reload = reload;
+#if ACTION_SCHEDULER_GROUPS > 0
+    nodeAt(freeCursor).group = (options.group <= ACTION_SCHEDULER_GROUPS) ? options.group : 0U;
+    if (nodeAt(freeCursor).group != 0U)
+    {
+        linkGroupNodeAt(freeCursor);
+    }
+#endif
+#if ACTION_SCHEDULER_ENABLE_FRACTIONAL_RELOAD
+    nodeAt(freeCursor).reloadNum = 0U;
+    nodeAt(freeCursor).reloadAcc = 0U;
+#endif
+#if ACTION_SCHEDULER_PRIORITY_LEVELS > 1
+    nodeAt(freeCursor).priority = (options.priority < ACTION_SCHEDULER_PRIORITY_LEVELS) ? options.priority : (uint8_t)(ACTION_SCHEDULER_PRIORITY_LEVELS - 1U);
+#endif
+#if ACTION_SCHEDULER_ENABLE_DEADLINES
+    nodeAt(freeCursor).completionDeadline = options.deadline;
+#endif
+#if ACTION_SCHEDULER_ENABLE_EXECUTOR
+    nodeAt(freeCursor).affinity = options.affinity;
+#endif
+    *slotIdx = freeCursor;
+    return true;
+}
+
+#if ACTION_SCHEDULER_RESERVE_CLASSES > 0
+bool ActionSchedulerCore::reserveSlot(uint8_t reserveClass) {
+    if (mClassUsed[reserveClass] < mClassReserved[reserveClass])
+    {
+        // taken from the own reservation, which is always kept free
+        mReservedIdle--;
+    }
+    else if ((uint16_t)(mCapacity - mUsedNodes) <= mReservedIdle)
+    {
+        // the slots left are all reserved by other classes
+        mClassRejectCount[reserveClass]++;
+        return false;
+    }
+    mClassUsed[reserveClass]++;
+    mUsedNodes++;
+    if (mClassUsed[reserveClass] > mClassWaterMark[reserveClass])
+    {
+        mClassWaterMark[reserveClass] = mClassUsed[reserveClass];
+    }
+    return true;
+}
+
+void ActionSchedulerCore::returnSlot(uint8_t reserveClass) {
+    mClassUsed[reserveClass]--;
+    mUsedNodes--;
+    if (mClassUsed[reserveClass] < mClassReserved[reserveClass])
+    {
+        mReservedIdle++;
+    }
+}
+#endif
+
+uint32_t ActionSchedulerCore::getRemainingTimeAt(uint8_t idx) {
+    uint32_t remaining = 0U;
+    if (nodeAt(idx).state == ACTION_NODE_TIMELINE)
+    {
+        // sum up the relative delays back to the head
+        uint8_t cursor = idx;
+        remaining = nodeAt(cursor).delayToPrevious;
+        while (cursor != mNodeStartIdx)
+        {
+            cursor = nodeAt(cursor).previousNodeIdx;
+            remaining += nodeAt(cursor).delayToPrevious;
+        }
+    }
+    return remaining;
+}
+
+#if ACTION_SCHEDULER_UNIQUE_BUCKETS > 0
+uint8_t ActionSchedulerCore::uniqueBucketOf(ActionCallback_t cb, void* arg) {
+    uintptr_t hash = (uintptr_t)cb ^ ((uintptr_t)arg * 31U);
+    hash ^= hash >> 8;
+    return (uint8_t)(hash & (ACTION_SCHEDULER_UNIQUE_BUCKETS - 1U));
+}
+
+uint8_t ActionSchedulerCore::findUniqueNode(ActionCallback_t cb, void* arg) {
+    uint8_t cursor = mUniqueBuckets[uniqueBucketOf(cb, arg)];
+    while (cursor != UINT8_MAX)
+    {
+        // a node being executed does not count, its run is already past
+        if ((nodeAt(cursor).callback == cb) && (nodeAt(cursor).arg == arg) &&
+            ((nodeAt(cursor).state == ACTION_NODE_TIMELINE) || (nodeAt(cursor).state == ACTION_NODE_READY)))
+        {
+            break;
+        }
+        cursor = nodeAt(cursor).uniqueNextIdx;
+    }
+    return cursor;
+}
+
+void ActionSchedulerCore::removeUniqueNode(uint8_t idx) {
+    uint8_t* link = &mUniqueBuckets[uniqueBucketOf(nodeAt(idx).callback, nodeAt(idx).arg)];
+    while (*link != UINT8_MAX)
+    {
+        if (*link == idx)
+        {
+            *link = nodeAt(idx).uniqueNextIdx;
+            break;
+        }
+        link = &nodeAt(*link).uniqueNextIdx;
+    }
+    nodeAt(idx).flags &= (uint8_t)~ACTION_NODE_FLAG_UNIQUE;
+}
+
+void ActionSchedulerCore::restartNodeAt(uint8_t idx, uint32_t delay) {
+    if (nodeAt(idx).state == ACTION_NODE_TIMELINE)
+    {
+        unlinkNodeAt(idx);
+    }
+    else
+    {
+        unlinkReadyNodeAt(idx);
+    }
+    linkNode(idx, delay);
+}
+
+ActionSchedulerId_t ActionSchedulerCore::scheduleUnique(uint32_t delayedTime, ActionCallback_t cb, void* arg, ActionUniquePolicy_t policy) {
+    uint16_t ActionSchedulerId = ACTION_SCHEDULER_ID_INVALID;
+    if (cb == NULL)
+    {
+        return ActionSchedulerId;
+    }
+
+    enterCriticalSection(); // Critical section begin
+    uint8_t cursor = findUniqueNode(cb, arg);
+    if (cursor != UINT8_MAX)
+    {
+        switch(policy)
+        {
+            case ACTION_UNIQUE_RESTART:
+                nodeAt(cursor).reload = delayedTime;
+                restartNodeAt(cursor, delayedTime);
+                break;
+            case ACTION_UNIQUE_KEEP_EARLIEST:
+                if (delayedTime < getRemainingTimeAt(cursor))
+                {
+                    nodeAt(cursor).reload = delayedTime;
+                    restartNodeAt(cursor, delayedTime);
+                }
+                break;
+            default:
+                // ACTION_UNIQUE_KEEP_EXISTING, nothing to change
+                break;
+        }
+        ActionSchedulerId = generateActionIdAt(cursor);
+    }
+    else
+    {
+        ActionOptions_t options = {};
+        if (createNode(&cursor, delayedTime, delayedTime, cb, arg, options, NULL, 0U))
+        {
+            uint8_t bucket = uniqueBucketOf(cb, arg);
+            nodeAt(cursor).uniqueNextIdx = mUniqueBuckets[bucket];
+            mUniqueBuckets[bucket] = cursor;
+            nodeAt(cursor).flags |= ACTION_NODE_FLAG_UNIQUE;
+            ActionSchedulerId = generateActionIdAt(cursor);
+        }
+#if ACTION_SCHEDULER_ENABLE_OVERFLOW_POLICY
+        else
+        {
+            mRejectedCount++;
+        }
+#endif
+    }
+    exitCriticalSection(); // Critical section end
+
+    return ActionSchedulerId;
+}
+#endif
+
+bool ActionSchedulerCore::post(uint32_t delayedTime, ActionCallback_t cb, void* arg) {
+    return postReload(delayedTime, delayedTime, cb, arg);
+}
+
+bool ActionSchedulerCore::postReload(uint32_t delayedTime, uint32_t reload, ActionCallback_t cb, void* arg) {
+#if ACTION_SCHEDULER_POST_QUEUE_SIZE > 0
+    if (cb == NULL)
+    {
+        return false;
+    }
+    ActionPostCell_t* cell;
+    uint16_t pos = __atomic_load_n(&mPostEnqueuePos, __ATOMIC_RELAXED);
+    for (;;)
+    {
+        cell = &mPostCells[pos & (ACTION_SCHEDULER_POST_QUEUE_SIZE - 1U)];
+        uint16_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        int16_t diff = (int16_t)(sequence - pos);
+        if (diff == 0)
+        {
+            // the cell is free for this position, try to claim it
+            if (__atomic_compare_exchange_n(&mPostEnqueuePos, &pos, (uint16_t)(pos + 1U), true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // the consumer has not drained this cell yet, the queue is full
+            return false;
+        }
+        else
+        {
+            // another producer took this position
+            pos = __atomic_load_n(&mPostEnqueuePos, __ATOMIC_RELAXED);
+        }
+    }
+    cell->callback = cb;
+    cell->arg = arg;
+    cell->delayedTime = delayedTime;
+    cell->reload = reload;
+    __atomic_store_n(&cell->sequence, (uint16_t)(pos + 1U), __ATOMIC_RELEASE);
+    return true;
+#else
+    (void)delayedTime;
+    (void)reload;
+    (void)cb;
+    (void)arg;
+    return false;
+#endif
+}
+
+#if ACTION_SCHEDULER_POST_QUEUE_SIZE > 0
+void ActionSchedulerCore::drainPostQueue() {
+    // At most one round of the queue, so producers posting as fast as it drains can't hold the pass forever
+    for (uint16_t n = 0; n < ACTION_SCHEDULER_POST_QUEUE_SIZE; n++)
+    {
+        uint16_t pos = mPostDequeuePos;
+        ActionPostCell_t* cell = &mPostCells[pos & (ACTION_SCHEDULER_POST_QUEUE_SIZE - 1U)];
+        if (__atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE) != (uint16_t)(pos + 1U))
+        {
+            // nothing published at this position yet
+            break;
+        }
+        if (scheduleReload(cell->delayedTime, cell->reload, cell->callback, cell->arg) == ACTION_SCHEDULER_ID_INVALID)
+        {
+            // No node left, the action stays queued until a pass frees one, and the producers see the queue filling up
+            break;
+        }
+        mPostDequeuePos = pos + 1U;
+        // hand the cell back to the producers for the next round
+        __atomic_store_n(&cell->sequence, (uint16_t)(pos + ACTION_SCHEDULER_POST_QUEUE_SIZE), __ATOMIC_RELEASE);
+    }
+}
+#endif
+
+ActionSchedulerId_t ActionSchedulerCore::schedule(uint32_t delayedTime, ActionCallback_t cb, void* arg) {
+    return scheduleReload(delayedTime, delayedTime, cb, arg);
+}
+
+ActionSchedulerId_t ActionSchedulerCore::scheduleLong(uint64_t delayedTime, ActionCallback_t cb, void* arg) {
+    uint16_t ActionSchedulerId = ACTION_SCHEDULER_ID_INVALID;
+    if (cb == NULL)
+    {
+        return ActionSchedulerId;
+    }
+
+    ActionOptions_t options = {};
+    enterCriticalSection(); // Critical section begin
+    uint8_t freeCursor;
+    if (delayedTime < ACTION_SCHEDULER_HORIZON)
+    {
+        if (createNode(&freeCursor, (uint32_t)delayedTime, 0U, cb, arg, options, NULL, 0U))
+        {
+            nodeAt(freeCursor).flags |= ACTION_NODE_FLAG_ONESHOT;
+            ActionSchedulerId = generateActionIdAt(freeCursor);
+        }
+    }
+    else if (allocNode(&freeCursor, 0U, cb, arg, options, NULL, 0U))
+    {
+        nodeAt(freeCursor).flags |= ACTION_NODE_FLAG_ONESHOT;
+        parkNodeAt(freeCursor, getNow64() + delayedTime);
+        ActionSchedulerId = generateActionIdAt(freeCursor);
+    }
+#if ACTION_SCHEDULER_ENABLE_OVERFLOW_POLICY
+    if (ActionSchedulerId == ACTION_SCHEDULER_ID_INVALID)
+    {
+        mRejectedCount++;
+    }
+#endif
+    exitCriticalSection(); // Critical section end
+
+    return ActionSchedulerId;
+}
+
+bool ActionSchedulerCore::unschedule(ActionSchedulerId_t* actionId) {
+    bool ret = false;
+    if (*actionId != ACTION_SCHEDULER_ID_INVALID)
+    {
+        enterCriticalSection(); // Critical section begin
+        uint8_t id = (uint8_t)(*actionId & 0xffU);
+        uint8_t counter = (uint8_t)(*actionId >> 8U);
+        if ((id < mCapacity) && hasNodeAt(id) && (nodeAt(id).callback != NULL) && (nodeAt(id).usedCounter == counter))
+        {
+            ret = true;
+            removeNodeAt(id);
+            *actionId = ACTION_SCHEDULER_ID_INVALID;
+        }
+        exitCriticalSection(); // Critical section end
+    }
+    return ret;
+}
+
+bool ActionSchedulerCore::setReload(ActionSchedulerId_t actionId, uint32_t reload) {
+    bool ret = false;
+    uint8_t id = (uint8_t)(actionId & 0xffU);
+    uint8_t counter = (uint8_t)(actionId >> 8U);
+    if (id >= mCapacity)
+    {
+        return ret;
+    }
+    enterCriticalSection(); // Critical section begin
+    // a one-shot action has no period, and a parked one keeps the upper deadline word in its reload
+    if (hasNodeAt(id) && (nodeAt(id).callback != NULL) && (nodeAt(id).usedCounter == counter) &&
+        ((nodeAt(id).flags & ACTION_NODE_FLAG_ONESHOT) == 0U))
+    {
+        nodeAt(id).reload = reload;
+#if ACTION_SCHEDULER_ENABLE_FRACTIONAL_RELOAD
+        nodeAt(id).reloadNum = 0U;
+#endif
+        ret = true;
+    }
+    exitCriticalSection(); // Critical section end
+    return ret;
+}
+
+bool ActionSchedulerCore::freezeNodeAt(uint8_t idx, uint32_t delay) {
+#if ACTION_SCHEDULER_GROUPS > 0
+    if ((nodeAt(idx).group != 0U) && mGroupSuspended[nodeAt(idx).group - 1U])
+    {
+        // the group is suspended, the node waits out of the timeline until resumeGroup()
+        nodeAt(idx).delayToPrevious = delay;
+        nodeAt(idx).state = ACTION_NODE_SUSPENDED;
+        return true;
+    }
+#else
+    (void)idx;
+    (void)delay;
+#endif
+    return false;
+}
+
+#if ACTION_SCHEDULER_GROUPS > 0
+void ActionSchedulerCore::linkGroupNodeAt(uint8_t idx) {
+    uint8_t* head = &mGroupHeads[nodeAt(idx).group - 1U];
+    nodeAt(idx).groupPrevIdx = UINT8_MAX;
+    nodeAt(idx).groupNextIdx = *head;
+    if (*head != UINT8_MAX)
+    {
+        nodeAt(*head).groupPrevIdx = idx;
+    }
+    *head = idx;
+}
+
+void ActionSchedulerCore::unlinkGroupNodeAt(uint8_t idx) {
+    uint8_t previousCursor = nodeAt(idx).groupPrevIdx;
+    uint8_t nextCursor = nodeAt(idx).groupNextIdx;
+    if (previousCursor == UINT8_MAX)
+    {
+        mGroupHeads[nodeAt(idx).group - 1U] = nextCursor;
+    }
+    else
+    {
+        nodeAt(previousCursor).groupNextIdx = nextCursor;
+    }
+    if (nextCursor != UINT8_MAX)
+    {
+        nodeAt(nextCursor).groupPrevIdx = previousCursor;
+    }
+    nodeAt(idx).group = 0U;
+}
+#endif
+
+bool ActionSchedulerCore::cancelGroup(uint8_t group) {
+    bool ret = false;
+#if ACTION_SCHEDULER_GROUPS > 0
+    if ((group == 0U) || (group > ACTION_SCHEDULER_GROUPS))
+    {
+        return ret;
+    }
+    enterCriticalSection(); // Critical section begin
+    uint8_t cursor = mGroupHeads[group - 1U];
+    while (cursor != UINT8_MAX)
+    {
+        // a running node stays in the list until proceed() releases it, so take the link first
+        uint8_t nextCursor = nodeAt(cursor).groupNextIdx;
+        if (nodeAt(cursor).callback != NULL)
+        {
+            ret = true;
+            removeNodeAt(cursor);
+        }
+        cursor = nextCursor;
+    }
+    exitCriticalSection(); // Critical section end
+#else
+    (void)group;
+#endif
+    return ret;
+}
+
+bool ActionSchedulerCore::suspendGroup(uint8_t group) {
+#if ACTION_SCHEDULER_GROUPS > 0
+    if ((group == 0U) || (group > ACTION_SCHEDULER_GROUPS))
+    {
+        return false;
+    }
+    enterCriticalSection(); // Critical section begin
+    mGroupSuspended[group - 1U] = true;
+    uint16_t linked = 0U;
+    uint8_t cursor = mGroupHeads[group - 1U];
+    while (cursor != UINT8_MAX)
+    {
+        uint8_t nextCursor = nodeAt(cursor).groupNextIdx;
+        if (nodeAt(cursor).state == ACTION_NODE_READY)
+        {
+            // due in this pass already, or collected early by a drain window
+            int32_t remaining = (int32_t)(nodeAt(cursor).delayToPrevious - mProceedingTime);
+            unlinkReadyNodeAt(cursor);
+            (void)freezeNodeAt(cursor, (remaining > 0) ? (uint32_t)remaining : 0U);
+        }
+        else if (nodeAt(cursor).state == ACTION_NODE_TIMELINE)
+        {
+            linked++;
+        }
+        cursor = nextCursor;
+    }
+    // The remaining times are prefix sums of the timeline, one walk up to the last node of the group
+    uint32_t elapsed = 0U;
+    cursor = mNodeStartIdx;
+    while (linked > 0U)
+    {
+        uint8_t nextCursor = nodeAt(cursor).nextNodeIdx;
+        uint32_t remaining = elapsed + nodeAt(cursor).delayToPrevious;
+        if (nodeAt(cursor).group == group)
+        {
+            // the delay goes over to the next node, so elapsed stays as it is
+            unlinkNodeAt(cursor);
+            (void)freezeNodeAt(cursor, remaining);
+            linked--;
+        }
+        else
+        {
+            elapsed = remaining;
+        }
+        cursor = nextCursor;
+    }
+    exitCriticalSection(); // Critical section end
+    return true;
+#else
+    (void)group;
+    return false;
+#endif
+}
+
+bool ActionSchedulerCore::resumeGroup(uint8_t group) {
+#if ACTION_SCHEDULER_GROUPS > 0
+    if ((group == 0U) || (group > ACTION_SCHEDULER_GROUPS))
+    {
+        return false;
+    }
+    enterCriticalSection(); // Critical section begin
+    mGroupSuspended[group - 1U] = false;
+    // The list is newest first, insert from its tail so equal remaining times keep their order
+    uint8_t cursor = mGroupHeads[group - 1U];
+    while ((cursor != UINT8_MAX) && (nodeAt(cursor).groupNextIdx != UINT8_MAX))
+    {
+        cursor = nodeAt(cursor).groupNextIdx;
+    }
+    while (cursor != UINT8_MAX)
+    {
+        if (nodeAt(cursor).state == ACTION_NODE_SUSPENDED)
+        {
+            linkNode(cursor, nodeAt(cursor).delayToPrevious);
+        }
+        cursor = nodeAt(cursor).groupPrevIdx;
+    }
+    if (mActiveNodes > mActiveNodesWaterMark)
+    {
+        mActiveNodesWaterMark = mActiveNodes;
+    }
+    exitCriticalSection(); // Critical section end
+    return true;
+#else
+    (void)group;
+    return false;
+#endif
+}
+
+bool ActionSchedulerCore::isPlainAt(uint8_t idx) {
+    // Whatever scheduleReload(reload, reload, cb, arg) would not restore elsewhere keeps the action here
+    if (nodeAt(idx).flags != 0U)
+    {
+        return false;
+    }
+#if ACTION_SCHEDULER_PRIORITY_LEVELS > 1
+    if (nodeAt(idx).priority != 0U)
+    {
+        return false;
+    }
+#endif
+#if ACTION_SCHEDULER_ENABLE_DEADLINES
+    if (nodeAt(idx).completionDeadline != 0U)
+    {
+        return false;
+    }
+#endif
+#if ACTION_SCHEDULER_ENABLE_EXECUTOR
+    if (nodeAt(idx).affinity != 0U)
+    {
+        return false;
+    }
+#endif
+#if ACTION_SCHEDULER_RESERVE_CLASSES > 0
+    if (nodeAt(idx).reserveClass != 0U)
+    {
+        return false;
+    }
+#endif
+#if ACTION_SCHEDULER_GROUPS > 0
+    if (nodeAt(idx).group != 0U)
+    {
+        return false;
+    }
+#endif
+#if ACTION_SCHEDULER_ENABLE_FRACTIONAL_RELOAD
+    if (nodeAt(idx).reloadNum != 0U)
+    {
+        return false;
+    }
+#endif
+#if ACTION_SCHEDULER_INLINE_ARG_SIZE > 0
+    if (nodeAt(idx).arg == nodeAt(idx).inlineArg.bytes)
+    {
+        // the payload lives in the node and is gone once the node is released
+        return false;
+    }
+#endif
+    return true;
+}
+
+bool ActionSchedulerCore::takeDueAction(ActionCallback_t* cb, void** arg, uint32_t* reload) {
+    bool ret = false;
+    enterCriticalSection(); // Critical section begin
+    if ((mActiveNodes > 0U) && (nodeAt(mNodeStartIdx).delayToPrevious == 0U))
+    {
+        // Go through the actions sharing the due deadline, the first plain one is taken
+        uint8_t currentCursor = mNodeStartIdx;
+        for (;;)
+        {
+            if (isPlainAt(currentCursor))
+            {
+                *cb = nodeAt(currentCursor).callback;
+                *arg = nodeAt(currentCursor).arg;
+                *reload = nodeAt(currentCursor).reload;
+                unlinkNodeAt(currentCursor);
+                releaseNodeAt(currentCursor);
+                ret = true;
+                break;
+            }
+            uint8_t nextCursor = nodeAt(currentCursor).nextNodeIdx;
+            if ((currentCursor == mNodeEndIdx) || (nodeAt(nextCursor).delayToPrevious != 0U))
+            {
+                break;
+            }
+            currentCursor = nextCursor;
+        }
+    }
+    exitCriticalSection(); // Critical section end
+    return ret;
+}
+
+bool ActionSchedulerCore::unscheduleAll(ActionCallback_t cb) {
+    bool ret = false;
+    if (cb == NULL)
+    {
+        return ret;
+    }
+    enterCriticalSection(); // Critical section begin
+    // The nodes can be in the timeline, in a ready queue or being executed, so go through the slots
+    for (uint16_t i = 0; i < mCapacity; i++)
+    {
+        // removing the last node of a slab detaches it, check before every access
+        if (hasNodeAt(i) && (nodeAt(i).callback == cb))
+        {
+            ret = true;
+            removeNodeAt((uint8_t)i);
+        }
+    }
+#if ACTION_SCHEDULER_ENABLE_SPILL
+    uint16_t kept = 0U;
+    for (uint16_t i = 0; i < mSpillCount; i++)
+    {
+        if (mSpill[i].callback == cb)
+        {
+            ret = true;
+        }
+        else
+        {
+            mSpill[kept++] = mSpill[i];
+        }
+    }
+    mSpillCount = kept;
+#endif
+    exitCriticalSection(); // Critical section end
+    return ret;
+}
+
+void ActionSchedulerCore::clear() {
+    enterCriticalSection(); // Critical section begin
+    for (uint16_t i = 0; i < mCapacity; i++)
+    {
+        if (!hasNodeAt(i))
+        {
+            continue;
+        }
+        nodeAt(i).usedCounter = 0U;
+        nodeAt(i).arg = NULL;
+        nodeAt(i).callback = NULL;
+        nodeAt(i).delayToPrevious = 0U;
+        nodeAt(i).reload = 0U;
+        nodeAt(i).nextNodeIdx = 0U;
+        nodeAt(i).previousNodeIdx = 0U;
+        nodeAt(i).state = ACTION_NODE_FREE;
+#if ACTION_SCHEDULER_PRIORITY_LEVELS > 1
+        nodeAt(i).priority = 0U;
+#endif
+        nodeAt(i).flags = 0U;
+#if ACTION_SCHEDULER_UNIQUE_BUCKETS > 0
+        nodeAt(i).uniqueNextIdx = UINT8_MAX;
+#endif
+#if ACTION_SCHEDULER_ENABLE_DEADLINES
+        nodeAt(i).completionDeadline = 0U;
+#endif
+    }
+    for (uint8_t level = 0; level < ACTION_SCHEDULER_PRIORITY_LEVELS; level++)
+    {
+        mReadyHead[level] = UINT8_MAX;
+        mReadyTail[level] = UINT8_MAX;
+    }
+#if ACTION_SCHEDULER_ENABLE_NODE_POOL
+    for (uint8_t slab = 0; slab < ACTION_SCHEDULER_MAX_SLABS; slab++)
+    {
+        mSlabUsed[slab] = 0U;
+        if ((mPool != NULL) && (mSlabs[slab] != NULL))
+        {
+            detachSlab(slab);
+        }
+    }
+#endif
+    mReadyMask = 0U;
+#if ACTION_SCHEDULER_UNIQUE_BUCKETS > 0
+    for (uint8_t bucket = 0; bucket < ACTION_SCHEDULER_UNIQUE_BUCKETS; bucket++)
+    {
+        mUniqueBuckets[bucket] = UINT8_MAX;
+    }
+#endif
+#if ACTION_SCHEDULER_GROUPS > 0
+    for (uint8_t group = 0; group < ACTION_SCHEDULER_GROUPS; group++)
+    {
+        mGroupHeads[group] = UINT8_MAX;
+        mGroupSuspended[group] = false;
+    }
+#endif
+#if ACTION_SCHEDULER_ENABLE_DEADLINES
+    mDeadlineMissCount = 0U;
+#endif
+#if ACTION_SCHEDULER_ENABLE_OVERFLOW_POLICY
+    mRejectedCount = 0U;
+    mEvictedCount = 0U;
+    mSpilledCount = 0U;
+#endif
+#if ACTION_SCHEDULER_ENABLE_SPILL
+    mSpillCount = 0U;
+#endif
+#if ACTION_SCHEDULER_RESERVE_CLASSES > 0
+    mReservedIdle = 0U;
+    mUsedNodes = 0U;
+    for (uint8_t i = 0; i < ACTION_SCHEDULER_RESERVE_CLASSES; i++)
+    {
+        mClassUsed[i] = 0U;
+        mClassWaterMark[i] = 0U;
+        mClassRejectCount[i] = 0U;
+        mReservedIdle += mClassReserved[i];
+    }
+#endif
+    mNodeStartIdx = 0;
+    mNodeEndIdx = 0;
+    mActiveNodes = 0;
+    mProceedingTime = 0;
+    mProceedingEpoch = 0;
+    mParkedHead = UINT8_MAX;
+    mGroupAnchorIdx = UINT8_MAX;
+    exitCriticalSection(); // Critical section end
+}
+
+uint32_t ActionSchedulerCore::getNextEventDelay() {
+    uint32_t ret;
+    ActionSequence_t sequence;
+    do {
+        sequence = readBegin();
+        ActionNode_t* head = (mActiveNodes > 0U) ? peekNodeAt(mNodeStartIdx) : NULL;
+        ret = (head != NULL) ? head->delayToPrevious : UINT32_MAX;
+    } while (readRetry(sequence));
+    return ret;
+}
+
+uint8_t ActionSchedulerCore::peekNext(ActionPeek_t* out, uint8_t k) {
+    uint8_t ret = 0U;
+    if (out == NULL)
+    {
+        return ret;
+    }
+    enterCriticalSection(); // Critical section begin
+    uint8_t cursor = mNodeStartIdx;
+    uint32_t remaining = 0U;
+    while ((ret < k) && (ret < mActiveNodes))
+    {
+        remaining += nodeAt(cursor).delayToPrevious;
+        out[ret].id = generateActionIdAt(cursor);
+        out[ret].callback = nodeAt(cursor).callback;
+        out[ret].remainingTime = remaining;
+        ret++;
+        cursor = nodeAt(cursor).nextNodeIdx;
+    }
+    exitCriticalSection(); // Critical section end
+    return ret;
+}
+
+uint8_t ActionSchedulerCore::peekNextLockFree(ActionPeek_t* out, uint8_t k) {
+    uint8_t ret;
+    if (out == NULL)
+    {
+        return 0U;
+    }
+    ActionSequence_t sequence;
+    do {
+        sequence = readBegin();
+        ret = 0U;
+        uint8_t cursor = mNodeStartIdx;
+        uint32_t remaining = 0U;
+        uint16_t activeNodes = mActiveNodes;
+        // A torn read can follow a stale link, the walk is bounded by k and checked before each step
+        while ((ret < k) && (ret < activeNodes) && (cursor < mCapacity))
+        {
+            ActionNode_t* node = peekNodeAt(cursor);
+            if (node == NULL)
+            {
+                break;
+            }
+            remaining += node->delayToPrevious;
+            out[ret].id = (ActionSchedulerId_t)(cursor | ((uint16_t)node->usedCounter << 8));
+            out[ret].callback = node->callback;
+            out[ret].remainingTime = remaining;
+            ret++;
+            cursor = node->nextNodeIdx;
+        }
+    } while (readRetry(sequence));
+    return ret;
+}
+
+uint64_t ActionSchedulerCore::getProceedingTime64() {
+    uint64_t ret;
+    ActionSequence_t sequence;
+    do {
+        sequence = readBegin();
+        ret = getNow64();
+    } while (readRetry(sequence));
+    return ret;
+}
+
+uint32_t ActionSchedulerCore::getProceedingTime() {
+    uint32_t ret;
+    ActionSequence_t sequence;
+    do {
+        sequence = readBegin();
+        ret = mProceedingTime;
+    } while (readRetry(sequence));
+    return ret;
+}
+
+void ActionSchedulerCore::clearProceedingTime() {
+    enterCriticalSection(); // Critical section begin
+#if ACTION_SCHEDULER_ENABLE_SPILL
+    for (uint16_t i = 0; i < mSpillCount; i++)
+    {
+        mSpill[i].deadline -= mProceedingTime;
+    }
+#endif
+    // The parked deadlines are absolute, move them along with the time base
+    uint64_t now = getNow64();
+    uint8_t cursor = mParkedHead;
+    while (cursor != UINT8_MAX)
+    {
+        uint64_t deadline = (((uint64_t)nodeAt(cursor).reload << 32) | nodeAt(cursor).delayToPrevious) - now;
+        nodeAt(cursor).delayToPrevious = (uint32_t)deadline;
+        nodeAt(cursor).reload = (uint32_t)(deadline >> 32);
+        cursor = (nodeAt(cursor).nextNodeIdx == cursor) ? UINT8_MAX : nodeAt(cursor).nextNodeIdx;
+    }
+    mHorizonCheck -= mProceedingTime;
+    mProceedingEpoch = 0;
+    mProceedingTime = 0;
+    // The anchor deadline is relative to the proceeding time, it is not valid anymore
+    mGroupAnchorIdx = UINT8_MAX;
+    exitCriticalSection(); // Critical section end
+}
+
+bool ActionSchedulerCore::isCallbackArmed(ActionCallback_t cb) {
+    bool ret;
+    ActionSequence_t sequence;
+    do {
+        sequence = readBegin();
+        ret = false;
+        for (uint16_t i = 0; i < mCapacity; i++)
+        {
+            ActionNode_t* node = peekNodeAt(i);
+            if ((node != NULL) && (node->callback == cb))
+            {
+                ret = true;
+                break;
+            }
+        }
+    } while (readRetry(sequence));
+    return ret;
+}
+
+uint16_t ActionSchedulerCore::getActiveNodesWaterMark() {
+    uint16_t ret;
+    ActionSequence_t sequence;
+    do {
+        sequence = readBegin();
+        ret = mActiveNodesWaterMark;
+    } while (readRetry(sequence));
+    return ret;
+}
+
+bool ActionSchedulerCore::setOverflowPolicy(ActionOverflowPolicy_t policy) {
+#if !ACTION_SCHEDULER_ENABLE_SPILL
+    if (policy == ACTION_OVERFLOW_SPILL)
+    {
+        return false;
+    }
+#endif
+#if ACTION_SCHEDULER_ENABLE_OVERFLOW_POLICY
+    enterCriticalSection(); // Critical section begin
+    mOverflowPolicy = policy;
+    exitCriticalSection(); // Critical section end
+    return true;
+#else
+    // a full pool always rejects
+    return policy == ACTION_OVERFLOW_REJECT;
+#endif
+}
+
+uint32_t ActionSchedulerCore::getRejectedCount() {
+    uint32_t ret = 0U;
+#if ACTION_SCHEDULER_ENABLE_OVERFLOW_POLICY
+    ActionSequence_t sequence;
+    do {
+        sequence = readBegin();
+        ret = mRejectedCount;
+    } while (readRetry(sequence));
+#endif
+    return ret;
+}
+
+uint32_t ActionSchedulerCore::getEvictedCount() {
+    uint32_t ret = 0U;
+#if ACTION_SCHEDULER_ENABLE_OVERFLOW_POLICY
+    ActionSequence_t sequence;
+    do {
+        sequence = readBegin();
+        ret = mEvictedCount;
+    } while (readRetry(sequence));
+#endif
+    return ret;
+}
+
+uint32_t ActionSchedulerCore::getSpilledCount() {
+    uint32_t ret = 0U;
+#if ACTION_SCHEDULER_ENABLE_OVERFLOW_POLICY
+    ActionSequence_t sequence;
+    do {
+        sequence = readBegin();
+        ret = mSpilledCount;
+    } while (readRetry(sequence));
+#endif
+    return ret;
+}
+
+bool ActionSchedulerCore::setReservation(uint8_t reserveClass, uint8_t slots) {
+#if ACTION_SCHEDULER_RESERVE_CLASSES > 0
+    bool ret = false;
+    if (reserveClass >= ACTION_SCHEDULER_RESERVE_CLASSES)
+    {
+        return ret;
+    }
+    enterCriticalSection(); // Critical section begin
+    uint16_t reserved = slots;
+    for (uint8_t i = 0; i < ACTION_SCHEDULER_RESERVE_CLASSES; i++)
+    {
+        reserved += (i != reserveClass) ? mClassReserved[i] : 0U;
+    }
+    uint8_t used = mClassUsed[reserveClass];
+    uint16_t idle = mReservedIdle - ((mClassReserved[reserveClass] > used) ? (uint16_t)(mClassReserved[reserveClass] - used) : 0U);
+    idle += (slots > used) ? (uint16_t)(slots - used) : 0U;
+    // the new reservation has to fit in the slots nobody holds right now
+    if ((reserved <= mCapacity) && (idle <= (uint16_t)(mCapacity - mUsedNodes)))
+    {
+        mClassReserved[reserveClass] = slots;
+        mReservedIdle = idle;
+        ret = true;
+    }
+    exitCriticalSection(); // Critical section end
+    return ret;
+#else
+    (void)reserveClass;
+    (void)slots;
+    return false;
+#endif
+}
+
+uint8_t ActionSchedulerCore::getClassWaterMark(uint8_t reserveClass) {
+#if ACTION_SCHEDULER_RESERVE_CLASSES > 0
+    if (reserveClass >= ACTION_SCHEDULER_RESERVE_CLASSES)
+    {
+        return 0U;
+    }
+    uint8_t ret;
+    ActionSequence_t sequence;
+    do {
+        sequence = readBegin();
+        ret = mClassWaterMark[reserveClass];
+    } while (readRetry(sequence));
+    return ret;
+#else
+    (void)reserveClass;
+    return 0U;
+#endif
+}
+
+uint32_t ActionSchedulerCore::getClassRejectCount(uint8_t reserveClass) {
+#if ACTION_SCHEDULER_RESERVE_CLASSES > 0
+    if (reserveClass >= ACTION_SCHEDULER_RESERVE_CLASSES)
+    {
+        return 0U;
+    }
+    uint32_t ret;
+    ActionSequence_t sequence;
+    do {
+        sequence = readBegin();
+        ret = mClassRejectCount[reserveClass];
+    } while (readRetry(sequence));
+    return ret;
+#else
+    (void)reserveClass;
+    return 0U;
+#endif
+}
+
+void ActionSchedulerCore::setClock(ActionSchedulerClock_t clock) {
+    mClock = clock;
+}
+
+uint32_t ActionSchedulerCore::getPhaseError(ActionSchedulerId_t actionId) {
+    uint32_t ret = 0U;
+#if ACTION_SCHEDULER_ENABLE_PHASE_ERROR
+    uint8_t id = (uint8_t)(actionId & 0xffU);
+    uint8_t counter = (uint8_t)(actionId >> 8U);
+    if (id >= mCapacity)
+    {
+        return ret;
+    }
+    enterCriticalSection(); // Critical section begin
+    if (hasNodeAt(id) && (nodeAt(id).callback != NULL) && (nodeAt(id).usedCounter == counter))
+    {
+        ret = nodeAt(id).phaseError;
+    }
+    exitCriticalSection(); // Critical section end
+#else
+    (void)actionId;
+#endif
+    return ret;
+}
+
+void ActionSchedulerCore::setDeadlineMissHook(ActionDeadlineMissHook_t hook) {
+#if ACTION_SCHEDULER_ENABLE_DEADLINES
+    mDeadlineMissHook = hook;
+#else
+    (void)hook;
+#endif
+}
+
+uint32_t ActionSchedulerCore::getDeadlineMissCount() {
+    uint32_t ret = 0U;
+#if ACTION_SCHEDULER_ENABLE_DEADLINES
+    ActionSequence_t sequence;
+    do {
+        sequence = readBegin();
+        ret = mDeadlineMissCount;
+    } while (readRetry(sequence));
+#endif
     return ret;
 }
 
-uint16_t ActionScheduler::getActiveNodesWaterMark() {
-    return mActiveNodesWaterMark;
-}
\ No newline at end of file
+void ActionSchedulerCore::setExecutor(ActionExecutor_t executor, void* context) {
+#if ACTION_SCHEDULER_ENABLE_EXECUTOR
+    enterCriticalSection(); // Critical section begin
+    mExecutor = executor;
+    mExecutorContext = context;
+    exitCriticalSection(); // Critical section end
+#else
+    (void)executor;
+    (void)context;
+#endif
+}
+
+bool ActionSchedulerCore::complete(ActionSchedulerId_t actionId, ActionReturn_t actionRet) {
+    bool ret = false;
+    uint8_t id = (uint8_t)(actionId & 0xffU);
+    uint8_t counter = (uint8_t)(actionId >> 8U);
+    if (id >= mCapacity)
+    {
+        return ret;
+    }
+    enterCriticalSection(); // Critical section begin
+    if (hasNodeAt(id) && (nodeAt(id).state == ACTION_NODE_RUNNING) && (nodeAt(id).usedCounter == counter))
+    {
+        // The action can be unscheduled while the job runs, result in callback changed to null
+        if ((actionRet == ACTION_RELOAD) && (nodeAt(id).callback != NULL) && ((nodeAt(id).flags & ACTION_NODE_FLAG_ONESHOT) == 0U))
+        {
+            // the proceeding time has moved on while the job ran, that is its run time
+            reloadNodeAt(id, 0U);
+            ret = true;
+        }
+        else
+        {
+            releaseNodeAt(id);
+        }
+    }
+    exitCriticalSection(); // Critical section end
+    return ret;
+}
@@ -14,6 +14,7 @@
  * - ISR-safe operation
  * - Support for event callback chains
  * - Compatible with low-power operations
+ * - Actions sharing a deadline are grouped, so same-period tasks cost one timeline walk
  */
 
 #ifndef ACTION_SCHEDULER_H
@@ -22,8 +23,8 @@
 #include <Arduino.h>
 
 /**
- * @brief Maximum number of nodes that can be scheduled simultaneously
- * @note Can be overridden in Arduino IDE, must not exceed 255
+ * @brief Maximum number of nodes that can be scheduled simultaneously by an ActionScheduler
+ * @note Can be overridden in Arduino IDE, must not exceed 255. ActionSchedulerCore takes its capacity at runtime
  */
 #ifndef ACTION_SCHEDULER_MAX_NODES
 #define ACTION_SCHEDULER_MAX_NODES 64U
@@ -33,12 +34,226 @@
 #error ACTION_SCHEDULER_MAX_NODES cannot exceed 255! For now
 #endif
 
+/**
+ * @brief Length of a scheduler tick in microseconds, the unit of every delay, period and elapsed time
+ * @note 1000 (default) for milliseconds, e.g. 1 to run proceed() from micros() or 100 for a 10 kHz timer.
+ *       Delays are 32-bit, so a microsecond tick wraps after 71.6 minutes, longer delays go through scheduleLong()
+ */
+#ifndef ACTION_SCHEDULER_TICK_US
+#define ACTION_SCHEDULER_TICK_US 1000UL
+#endif
+
+#if ACTION_SCHEDULER_TICK_US < 1
+#error ACTION_SCHEDULER_TICK_US must be at least 1!
+#endif
+
+/**
+ * @brief Convert a duration to ticks, e.g. schedule(ACTION_MS(250), cb, arg) whatever the tick length
+ * @note Computed in 64 bits and rounded up to a whole tick, so a non-zero duration never becomes a zero delay.
+ *       Constant arguments fold at compile time
+ */
+#define ACTION_US(us) ((((uint64_t)(us)) + ACTION_SCHEDULER_TICK_US - 1U) / ACTION_SCHEDULER_TICK_US)
+#define ACTION_MS(ms) ACTION_US((uint64_t)(ms) * 1000U)
+#define ACTION_SECONDS(s) ACTION_US((uint64_t)(s) * 1000000U)
+
+/**
+ * @brief Largest capacity of one scheduler, node indexes are 8-bit and UINT8_MAX marks no node
+ */
+#define ACTION_SCHEDULER_MAX_CAPACITY 254U
+
+/**
+ * @brief Lets schedulers take their nodes in slabs from a shared ActionNodePool, see ActionNodePool.h
+ * @note Adds a slab table per instance and one indirection per node access, so it is disabled by default
+ */
+#ifndef ACTION_SCHEDULER_ENABLE_NODE_POOL
+#define ACTION_SCHEDULER_ENABLE_NODE_POOL 0
+#endif
+
+/**
+ * @brief Number of nodes in a slab of an ActionNodePool
+ * @note Must be a power of 2 between 1 and 128
+ */
+#ifndef ACTION_SCHEDULER_SLAB_NODES
+#define ACTION_SCHEDULER_SLAB_NODES 8U
+#endif
+
+#if (ACTION_SCHEDULER_SLAB_NODES < 1) || (ACTION_SCHEDULER_SLAB_NODES > 128) || ((ACTION_SCHEDULER_SLAB_NODES & (ACTION_SCHEDULER_SLAB_NODES - 1)) != 0)
+#error ACTION_SCHEDULER_SLAB_NODES must be a power of 2 between 1 and 128!
+#endif
+
+/**
+ * @brief Number of slabs covering the largest capacity
+ */
+#define ACTION_SCHEDULER_MAX_SLABS ((ACTION_SCHEDULER_MAX_CAPACITY + ACTION_SCHEDULER_SLAB_NODES - 1U) / ACTION_SCHEDULER_SLAB_NODES)
+
+/**
+ * @brief Number of priority levels, 0 is the lowest and ACTION_SCHEDULER_PRIORITY_LEVELS - 1 the highest
+ * @note Can be overridden in Arduino IDE, must be between 1 and 8. 1 (default) disables priorities,
+ *       from 2 on it costs 1 byte per node
+ */
+#ifndef ACTION_SCHEDULER_PRIORITY_LEVELS
+#define ACTION_SCHEDULER_PRIORITY_LEVELS 1U
+#endif
+
+#if (ACTION_SCHEDULER_PRIORITY_LEVELS < 1) || (ACTION_SCHEDULER_PRIORITY_LEVELS > 8)
+#error ACTION_SCHEDULER_PRIORITY_LEVELS must be between 1 and 8!
+#endif
+
+/**
+ * @brief Ordering of actions that share the same deadline
+ * @note 1 (default): stable, actions with the same deadline run in the order they were scheduled (FIFO),
+ *       a reloaded action counts as scheduled when it is re-armed.
+ *       0: unordered fast mode, a new action is placed in front of the actions with the same deadline,
+ *       which saves walking over them on insertion. No order is guaranteed among equal deadlines.
+ */
+#ifndef ACTION_SCHEDULER_STABLE_ORDER
+#define ACTION_SCHEDULER_STABLE_ORDER 1
+#endif
+
+/**
+ * @brief Enables completion deadlines (earliest-deadline-first dispatch and miss accounting)
+ * @note Costs 4 bytes per node, so it is disabled by default. When disabled, ActionOptions_t::deadline is ignored
+ */
+#ifndef ACTION_SCHEDULER_ENABLE_DEADLINES
+#define ACTION_SCHEDULER_ENABLE_DEADLINES 0
+#endif
+
+/**
+ * @brief Number of entries in the lock-free post queue, 0 to disable it
+ * @note Must be a power of 2 not exceeding 16384. Intended for host builds with many producer threads,
+ *       it relies on the GCC __atomic builtins
+ */
+#ifndef ACTION_SCHEDULER_POST_QUEUE_SIZE
+#define ACTION_SCHEDULER_POST_QUEUE_SIZE 0U
+#endif
+
+#if (ACTION_SCHEDULER_POST_QUEUE_SIZE & (ACTION_SCHEDULER_POST_QUEUE_SIZE - 1)) != 0 || ACTION_SCHEDULER_POST_QUEUE_SIZE > 16384
+#error ACTION_SCHEDULER_POST_QUEUE_SIZE must be a power of 2 not exceeding 16384!
+#endif
+
+/**
+ * @brief Enables handing due callbacks to an executor (e.g. a thread pool) instead of running them in proceed()
+ * @note Costs 1 byte per node for the affinity group, disabled by default
+ */
+#ifndef ACTION_SCHEDULER_ENABLE_EXECUTOR
+#define ACTION_SCHEDULER_ENABLE_EXECUTOR 0
+#endif
+
+/**
+ * @brief Bytes of inline argument storage per node, 0 to disable
+ * @note With storage, scheduleInline() and scheduleLambda() copy their payload into the node itself,
+ *       so callbacks can carry more context than a void* without a heap or a global pool. Costs the bytes on every node
+ */
+#ifndef ACTION_SCHEDULER_INLINE_ARG_SIZE
+#define ACTION_SCHEDULER_INLINE_ARG_SIZE 0U
+#endif
+
+#if ACTION_SCHEDULER_INLINE_ARG_SIZE > 255
+#error ACTION_SCHEDULER_INLINE_ARG_SIZE cannot exceed 255!
+#endif
+
+/**
+ * @brief Number of reservation classes partitioning the node pool, 0 (default) disables it
+ * @note Must not exceed 8. Each class can reserve a guaranteed minimum of slots with setReservation(),
+ *       which the other classes cannot take. Costs 1 byte per node
+ */
+#ifndef ACTION_SCHEDULER_RESERVE_CLASSES
+#define ACTION_SCHEDULER_RESERVE_CLASSES 0
+#endif
+
+#if ACTION_SCHEDULER_RESERVE_CLASSES > 8
+#error ACTION_SCHEDULER_RESERVE_CLASSES cannot exceed 8!
+#endif
+
+/**
+ * @brief Enables the ACTION_OVERFLOW_SPILL policy, a growable heap-backed store for actions that find the pool full
+ * @note Uses malloc()/realloc(), meant for host builds. Disabled by default
+ */
+#ifndef ACTION_SCHEDULER_ENABLE_SPILL
+#define ACTION_SCHEDULER_ENABLE_SPILL 0
+#endif
+
+/**
+ * @brief Enables setOverflowPolicy() and the rejected, evicted and spilled counters
+ * @note Costs 16 bytes per scheduler, disabled by default unless ACTION_SCHEDULER_ENABLE_SPILL is set.
+ *       When disabled, a full pool always rejects and the counters read 0
+ */
+#ifndef ACTION_SCHEDULER_ENABLE_OVERFLOW_POLICY
+#define ACTION_SCHEDULER_ENABLE_OVERFLOW_POLICY ACTION_SCHEDULER_ENABLE_SPILL
+#endif
+
+#if ACTION_SCHEDULER_ENABLE_SPILL && !ACTION_SCHEDULER_ENABLE_OVERFLOW_POLICY
+#error ACTION_SCHEDULER_ENABLE_SPILL needs ACTION_SCHEDULER_ENABLE_OVERFLOW_POLICY!
+#endif
+
+/**
+ * @brief Enables reload periods with a fractional part, scheduleReloadRational()
+ * @note Costs 3 bytes per node, disabled by default
+ */
+#ifndef ACTION_SCHEDULER_ENABLE_FRACTIONAL_RELOAD
+#define ACTION_SCHEDULER_ENABLE_FRACTIONAL_RELOAD 0
+#endif
+
+/**
+ * @brief Enables the per-action phase error, getPhaseError()
+ * @note Costs 4 bytes per node, disabled by default
+ */
+#ifndef ACTION_SCHEDULER_ENABLE_PHASE_ERROR
+#define ACTION_SCHEDULER_ENABLE_PHASE_ERROR 0
+#endif
+
+/**
+ * @brief Number of action groups, 0 (default) disables them
+ * @note Must not exceed 254. Group IDs go from 1 to ACTION_SCHEDULER_GROUPS, 0 is no group.
+ *       Each group keeps an intrusive list of its actions for cancelGroup(), suspendGroup() and resumeGroup().
+ *       Costs 3 bytes per node and 2 bytes per group
+ */
+#ifndef ACTION_SCHEDULER_GROUPS
+#define ACTION_SCHEDULER_GROUPS 0
+#endif
+
+#if ACTION_SCHEDULER_GROUPS > 254
+#error ACTION_SCHEDULER_GROUPS cannot exceed 254!
+#endif
+
+/**
+ * @brief Number of hash buckets indexing the actions scheduled by scheduleUnique(), 0 (default) disables it
+ * @note Must be a power of 2 not exceeding 128, costs 1 byte per bucket and 1 byte per node
+ */
+#ifndef ACTION_SCHEDULER_UNIQUE_BUCKETS
+#define ACTION_SCHEDULER_UNIQUE_BUCKETS 0U
+#endif
+
+#if (ACTION_SCHEDULER_UNIQUE_BUCKETS > 128) || ((ACTION_SCHEDULER_UNIQUE_BUCKETS & (ACTION_SCHEDULER_UNIQUE_BUCKETS - 1)) != 0)
+#error ACTION_SCHEDULER_UNIQUE_BUCKETS must be 0 or a power of 2 not exceeding 128!
+#endif
+
 /**
  * @brief Invalid scheduler ID value
  */
-// If you are to refactor the MAX_ACTION_SCHEDULER_NODES to be greater than 254, pay attention to this constant, make it right
+// If you are to refactor the ACTION_SCHEDULER_MAX_NODES to be greater than 254, pay attention to this constant, make it right
 #define ACTION_SCHEDULER_ID_INVALID UINT16_MAX
 
+/**
+ * @brief Delays of scheduleLong() from this value on wait in the parked list instead of the timeline
+ * @note 2^30 ticks, about 12.4 days with millisecond ticks, the parked list is only scanned every half of it
+ */
+#define ACTION_SCHEDULER_HORIZON 0x40000000UL
+
+/**
+ * @brief ID returned for an action accepted into the spill store, it has no node yet so it cannot be unscheduled by ID
+ */
+#define ACTION_SCHEDULER_ID_SPILLED (UINT16_MAX - 1U)
+
+/**
+ * @brief What scheduling does when the node pool is full
+ */
+typedef enum {
+    ACTION_OVERFLOW_REJECT,         /**< Return ACTION_SCHEDULER_ID_INVALID (default) */
+    ACTION_OVERFLOW_EVICT_LATEST,   /**< Drop the action with the latest deadline if the new one is due earlier */
+    ACTION_OVERFLOW_SPILL           /**< Keep the action in the spill store until a node frees up (needs ACTION_SCHEDULER_ENABLE_SPILL) */
+} ActionOverflowPolicy_t;
+
 /**
  * @brief Return type for action callbacks indicating if the action should be reloaded
  */
@@ -60,36 +275,241 @@ typedef ActionReturn_t (*ActionCallback_t)(void* arg);
 typedef uint16_t ActionSchedulerId_t;
 
 /**
- * @class ActionScheduler
+ * @brief What scheduleUnique() does when the same callback and arg is already pending
+ */
+typedef enum {
+    ACTION_UNIQUE_KEEP_EXISTING,  /**< Keep the pending action as it is */
+    ACTION_UNIQUE_RESTART,        /**< Restart the pending action's timer with the new delay */
+    ACTION_UNIQUE_KEEP_EARLIEST   /**< Use the new delay only if it is due earlier than the pending action */
+} ActionUniquePolicy_t;
+
+/**
+ * @brief What a reloaded action's next deadline is relative to
+ */
+typedef enum {
+    ACTION_RELOAD_FIXED_RATE,   /**< The deadline it was due at: a late proceed() or a slow callback does not shift the phase */
+    ACTION_RELOAD_FIXED_DELAY   /**< The completion of its callback, measured with the clock set by setClock() */
+} ActionReloadMode_t;
+
+/**
+ * @brief Function pointer type for a free running clock, e.g. millis
+ * @return Current time in the same unit as the time passed to proceed()
+ */
+typedef uint32_t (*ActionSchedulerClock_t)(void);
+
+/**
+ * @brief Function pointer type for the deadline miss hook
+ * @param id ID of the action that missed its deadline
+ * @param cb Callback of the action
+ * @param arg User data of the action
+ * @param overrun How late the action completed (or started) after its deadline
+ */
+typedef void (*ActionDeadlineMissHook_t)(ActionSchedulerId_t id, ActionCallback_t cb, void* arg, uint32_t overrun);
+
+/**
+ * @brief Optional per-action settings for scheduleReload()
+ *
+ * A zero-initialized instance (ActionOptions_t options = {};) gives the same
+ * behaviour as the plain scheduleReload(), so only the fields of interest need to be set.
+ */
+typedef struct {
+    uint8_t priority;   /**< Priority level, higher runs first among the actions due when proceed() runs (needs ACTION_SCHEDULER_PRIORITY_LEVELS) */
+    uint32_t deadline;  /**< Completion deadline relative to each release, 0 for none (needs ACTION_SCHEDULER_ENABLE_DEADLINES) */
+    uint8_t affinity;   /**< Serial affinity group for the executor, 0 for independent (needs ACTION_SCHEDULER_ENABLE_EXECUTOR) */
+    uint8_t reserveClass; /**< Reservation class the slot is taken from, 0 by default (needs ACTION_SCHEDULER_RESERVE_CLASSES) */
+    uint8_t reloadMode; /**< ActionReloadMode_t, ACTION_RELOAD_FIXED_RATE by default */
+    uint8_t group;      /**< Group of the action, 1 to ACTION_SCHEDULER_GROUPS, 0 for none (needs ACTION_SCHEDULER_GROUPS) */
+} ActionOptions_t;
+
+/**
+ * @brief A pending action as reported by peekNext()
+ */
+typedef struct {
+    ActionSchedulerId_t id;     /**< ID of the action */
+    ActionCallback_t callback;  /**< Callback function it executes */
+    uint32_t remainingTime;     /**< Ticks until it is due */
+} ActionPeek_t;
+
+/**
+ * @brief A due callback handed to the executor
+ */
+typedef struct {
+    ActionSchedulerId_t id;     /**< ID of the action, to be passed back to complete() */
+    ActionCallback_t callback;  /**< Callback function to execute */
+    void* arg;                  /**< User data to pass to callback */
+    uint8_t affinity;           /**< Jobs with the same non-zero affinity must run one after another on one thread */
+} ActionJob_t;
+
+/**
+ * @brief Function pointer type for an executor
+ * @param context User context given to setExecutor()
+ * @param job The due callback, the executor runs it and then calls complete() with the result
+ */
+typedef void (*ActionExecutor_t)(void* context, const ActionJob_t& job);
+
+class ActionNodePool;
+
+/**
+ * @brief Set when the compiler supports C++20 coroutines, see ActionSchedulerCoroutine.h
+ */
+#if defined(__cpp_impl_coroutine)
+#define ACTION_SCHEDULER_HAS_COROUTINES 1
+class ActionDelayAwaiter;
+#else
+#define ACTION_SCHEDULER_HAS_COROUTINES 0
+#endif
+
+/**
+ * @class ActionSchedulerCore
  * @brief Manages scheduled actions in a timeline-based linked list
  *
+ * The core works on node storage provided by the user, so every instance can have its own
+ * capacity, e.g. a few nodes per peripheral driver and a large pool for the application.
+ * ActionScheduler is the ready to use variant with ACTION_SCHEDULER_MAX_NODES nodes inside.
+ *
  * This class implements a scheduler that can manage multiple delayed or periodic
  * function calls. Events are stored in a timeline-based linked list, where earlier
  * events are closer to the head and later events are closer to the tail.
+ *
+ * Ordering guarantee: actions with different deadlines run in deadline order. With
+ * ACTION_SCHEDULER_STABLE_ORDER enabled (default), actions with the same deadline run in
+ * the order they were scheduled, the position in the timeline is the sequence number.
+ * Among the actions that are due within the time given to proceed(), whatever their deadlines,
+ * a higher priority runs first, the order above applies within each priority level. An action
+ * scheduled while they run and due within that time joins them. With
+ * ACTION_SCHEDULER_ENABLE_DEADLINES, the due actions of a level run earliest completion deadline
+ * first (EDF), an action without a deadline counts as due for completion at its release time.
  */
-class ActionScheduler {
+class ActionSchedulerCore {
 public:
+#if ACTION_SCHEDULER_INLINE_ARG_SIZE > 0
+    typedef union {
+        uint8_t bytes[ACTION_SCHEDULER_INLINE_ARG_SIZE];
+        void* alignPointer;
+        uint64_t alignInteger;
+        double alignDouble;
+    } ActionInlineArg_t;
+#endif
+
     /**
-     * @brief Constructs a new ActionScheduler instance
+     * @brief Storage of one scheduled action, opaque to the user
+     */
+    typedef struct {
+        ActionCallback_t callback;
+        uint32_t delayToPrevious;
+        uint32_t reload;
+        void* arg;
+        uint8_t usedCounter;
+        uint8_t previousNodeIdx;
+        uint8_t nextNodeIdx;
+        uint8_t state : 4;
+        uint8_t flags : 4;      // shares the byte with the state
+#if ACTION_SCHEDULER_PRIORITY_LEVELS > 1
+        uint8_t priority;
+#endif
+#if ACTION_SCHEDULER_UNIQUE_BUCKETS > 0
+        uint8_t uniqueNextIdx;
+#endif
+#if ACTION_SCHEDULER_ENABLE_DEADLINES
+        uint32_t completionDeadline;
+#endif
+#if ACTION_SCHEDULER_ENABLE_PHASE_ERROR
+        uint32_t phaseError;    // ticks the latest run started behind the grid of the reload period
+#endif
+#if ACTION_SCHEDULER_ENABLE_EXECUTOR
+        uint8_t affinity;
+#endif
+#if ACTION_SCHEDULER_RESERVE_CLASSES > 0
+        uint8_t reserveClass;
+#endif
+#if ACTION_SCHEDULER_GROUPS > 0
+        uint8_t group;
+        uint8_t groupPrevIdx;   // links of the group list, UINT8_MAX at both ends
+        uint8_t groupNextIdx;
+#endif
+#if ACTION_SCHEDULER_ENABLE_FRACTIONAL_RELOAD
+        uint8_t reloadNum;  // fractional part of the period is reloadNum / reloadDen, 0 for none
+        uint8_t reloadDen;
+        uint8_t reloadAcc;  // fraction carried over from the previous periods
+#endif
+#if ACTION_SCHEDULER_INLINE_ARG_SIZE > 0
+        ActionInlineArg_t inlineArg;
+#endif
+    } ActionNode_t;
+
+    /**
+     * @brief Constructs a scheduler on top of user provided node storage
+     * @param nodes Node buffer, e.g. a static ActionNode_t array or a suitably aligned memory region
+     * @param capacity Number of nodes in the buffer, at most ACTION_SCHEDULER_MAX_CAPACITY
      *
-     * Initializes an empty scheduler with no active nodes.
+     * Initializes an empty scheduler with no active nodes. The buffer must outlive the scheduler.
      */
-    ActionScheduler();
+    ActionSchedulerCore(ActionNode_t* nodes, uint8_t capacity);
+
+#if ACTION_SCHEDULER_ENABLE_NODE_POOL
+    /**
+     * @brief Constructs a scheduler taking its nodes from a shared pool
+     * @param pool Pool to take the slabs from, must outlive the scheduler
+     * @param quota Maximum number of nodes this scheduler may hold, at most ACTION_SCHEDULER_MAX_CAPACITY
+     *
+     * The scheduler holds no nodes until actions are scheduled, a slab goes back to the pool
+     * as soon as its last action is released.
+     */
+    ActionSchedulerCore(ActionNodePool& pool, uint8_t quota);
+#endif
+
+    /**
+     * @brief Gets the number of bytes of node storage needed for a capacity
+     * @param capacity Number of nodes
+     * @return Size of the buffer to pass to the constructor, in bytes
+     */
+    static size_t requiredBytes(uint8_t capacity) {
+        return (size_t)capacity * sizeof(ActionNode_t);
+    }
+
+    /**
+     * @brief Gets the number of nodes this scheduler can hold
+     * @return Capacity in nodes
+     */
+    uint8_t getCapacity(void);
+
+#if ACTION_SCHEDULER_ENABLE_SPILL || ACTION_SCHEDULER_ENABLE_NODE_POOL
+    /**
+     * @brief Frees the spill store and gives the slabs back to the pool
+     */
+    ~ActionSchedulerCore();
+#endif
     
     /**
      * @brief Processes elapsed time and executes due callbacks
-     * @param timeElapsedMs Time elapsed since last proceed call in milliseconds
+     * @param ticksElapsed Time elapsed since last proceed call in ticks
      * @return true if any callbacks were executed, false otherwise
      *
      * Updates the scheduler's timeline by the specified amount of time and
      * executes any callbacks that are due. Callbacks are executed with
-     * interrupts enabled.
+     * interrupts enabled, highest priority first among all the due ones, then
+     * in deadline order. The proceeding time catches up with the deadline of each
+     * action as it runs (it never goes back), so an action scheduled from a
+     * callback is relative to that deadline (event callback chain).
+     * A reloaded action keeps its period relative to the deadline it was due at.
+     */
+    bool proceed(uint32_t ticksElapsed);
+
+    /**
+     * @brief Processes elapsed time and executes the callbacks due now or within a window
+     * @param ticksElapsed Time elapsed since last proceed call in ticks
+     * @param window Actions due within this many ticks from now are executed in this pass as well
+     * @return Delay in ticks until the next event after the window, or UINT32_MAX if no events are scheduled
+     *
+     * Meant for low-power loops: running the actions that are due shortly after the head in the same
+     * wakeup saves a sleep and wake transition per action. The early actions run at most window ticks
+     * ahead of their deadline, a reloaded one keeps its period relative to the deadline, so it does not drift.
      */
-    bool proceed(uint32_t timeElapsedMs);
+    uint32_t proceedWindow(uint32_t ticksElapsed, uint32_t window);
 
     /**
      * @brief Schedules an action
-     * @param delayedTime Delay before execution in milliseconds, and also subsequent reload period
+     * @param delayedTime Delay before execution in ticks, and also subsequent reload period
      * @param cb Callback function to execute
      * @param arg User data to pass to callback
      * @return ActionSchedulerId_t Unique ID for the scheduled action, or ACTION_SCHEDULER_ID_INVALID if scheduling failed
@@ -99,10 +519,40 @@ public:
      */
     ActionSchedulerId_t schedule(uint32_t delayedTime, ActionCallback_t cb, void* arg);
 
+    /**
+     * @brief Schedules a one-shot action with a 64-bit delay, e.g. months ahead
+     * @param delayedTime Delay before execution in ticks
+     * @param cb Callback function to execute, runs once whatever it returns
+     * @param arg User data to pass to callback
+     * @return ActionSchedulerId_t Unique ID for the scheduled action, or ACTION_SCHEDULER_ID_INVALID if scheduling failed
+     *
+     * Delays from ACTION_SCHEDULER_HORIZON on keep the node in a parked list with its 64-bit deadline,
+     * it only enters the timeline once it is less than the horizon away, so it costs nothing to the
+     * near-term insertions meanwhile. A periodic long action schedules its next run from its callback.
+     * Can be safely called from interrupt handlers.
+     */
+    ActionSchedulerId_t scheduleLong(uint64_t delayedTime, ActionCallback_t cb, void* arg);
+
+#if ACTION_SCHEDULER_UNIQUE_BUCKETS > 0
+    /**
+     * @brief Schedules an action unless the same callback and arg is already pending
+     * @param delayedTime Delay before execution in ticks, and also subsequent reload period
+     * @param cb Callback function to execute
+     * @param arg User data to pass to callback
+     * @param policy What to do with an already pending action, see ActionUniquePolicy_t
+     * @return ActionSchedulerId_t ID of the pending (existing or new) action, or ACTION_SCHEDULER_ID_INVALID if scheduling failed
+     *
+     * The pending action is found in O(1) through a hash index, so a storm of calls, e.g. from a
+     * bouncing button ISR, costs a single node. An action whose callback is being executed is no longer
+     * pending. Needs ACTION_SCHEDULER_UNIQUE_BUCKETS. Can be safely called from interrupt handlers.
+     */
+    ActionSchedulerId_t scheduleUnique(uint32_t delayedTime, ActionCallback_t cb, void* arg, ActionUniquePolicy_t policy);
+#endif
+
     /**
      * @brief Schedules an action with different reload value
-     * @param delayedTime Initial delay before first execution in milliseconds
-     * @param reload Period for subsequent executions in milliseconds
+     * @param delayedTime Initial delay before first execution in ticks
+     * @param reload Period for subsequent executions in ticks
      * @param cb Callback function to execute
      * @param arg User data to pass to callback
      * @return ActionSchedulerId_t Unique ID for the scheduled action, or ACTION_SCHEDULER_ID_INVALID if scheduling failed
@@ -112,6 +562,152 @@ public:
      */
     ActionSchedulerId_t scheduleReload(uint32_t delayedTime, uint32_t reload, ActionCallback_t cb, void* arg);
 
+    /**
+     * @brief Schedules an action with different reload value and extra options
+     * @param delayedTime Initial delay before first execution in ticks
+     * @param reload Period for subsequent executions in ticks
+     * @param cb Callback function to execute
+     * @param arg User data to pass to callback
+     * @param options Per-action options, e.g. the priority level (clamped to ACTION_SCHEDULER_PRIORITY_LEVELS - 1)
+     * @return ActionSchedulerId_t Unique ID for the scheduled action, or ACTION_SCHEDULER_ID_INVALID if scheduling failed
+     *
+     * Can be safely called from interrupt handlers.
+     */
+    ActionSchedulerId_t scheduleReload(uint32_t delayedTime, uint32_t reload, ActionCallback_t cb, void* arg, const ActionOptions_t& options);
+
+    /**
+     * @brief Schedules a one-shot action at an absolute proceeding time
+     * @param deadline Proceeding time to run at, in ticks, as returned by getProceedingTime()
+     * @param cb Callback function to execute, runs once whatever it returns
+     * @param arg User data to pass to callback
+     * @return ActionSchedulerId_t Unique ID for the scheduled action, or ACTION_SCHEDULER_ID_INVALID if scheduling failed
+     *
+     * The delay is computed inside the critical section, so a concurrent proceed() can't shift it.
+     * A deadline less than 2^31 ticks ahead is in the future, anything else has passed and runs on the next proceed().
+     * Can be safely called from interrupt handlers.
+     */
+    ActionSchedulerId_t scheduleAt(uint32_t deadline, ActionCallback_t cb, void* arg);
+
+    /**
+     * @brief Schedules a periodic action on the grid of an absolute anchor time
+     * @param anchor Proceeding time of one run, in ticks, the runs are at anchor + k * reload
+     * @param reload Period in ticks
+     * @param cb Callback function to execute
+     * @param arg User data to pass to callback
+     * @return ActionSchedulerId_t Unique ID for the scheduled action, or ACTION_SCHEDULER_ID_INVALID if scheduling failed
+     *
+     * An anchor in the past starts at the next point of its grid, so tasks sharing an anchor stay phase
+     * aligned whenever they are scheduled. Can be safely called from interrupt handlers.
+     */
+    ActionSchedulerId_t scheduleReloadAt(uint32_t anchor, uint32_t reload, ActionCallback_t cb, void* arg);
+
+    /**
+     * @brief Schedules a periodic action on the grid of an absolute anchor time, with extra options
+     * @param anchor Proceeding time of one run, in ticks, the runs are at anchor + k * reload
+     * @param reload Period in ticks
+     * @param cb Callback function to execute
+     * @param arg User data to pass to callback
+     * @param options Per-action options, as for scheduleReload()
+     * @return ActionSchedulerId_t Unique ID for the scheduled action, or ACTION_SCHEDULER_ID_INVALID if scheduling failed
+     *
+     * Can be safely called from interrupt handlers.
+     */
+    ActionSchedulerId_t scheduleReloadAt(uint32_t anchor, uint32_t reload, ActionCallback_t cb, void* arg, const ActionOptions_t& options);
+
+#if ACTION_SCHEDULER_ENABLE_FRACTIONAL_RELOAD
+    /**
+     * @brief Schedules an action with a period of periodNum / periodDen ticks, e.g. 100 / 3 for 30 Hz with millisecond ticks
+     * @param delayedTime Initial delay before first execution in ticks
+     * @param periodNum Numerator of the period, in ticks
+     * @param periodDen Denominator of the period, from 1 to 255
+     * @param cb Callback function to execute
+     * @param arg User data to pass to callback
+     * @return ActionSchedulerId_t Unique ID for the scheduled action, or ACTION_SCHEDULER_ID_INVALID if scheduling failed
+     *
+     * The re-arm carries the fraction over in an integer accumulator, so the runs are 33, 33, 34 ticks
+     * apart and never drift from the exact rate. An action spilled on overflow keeps the integer period only,
+     * and setReload() sets an integer period again. Can be safely called from interrupt handlers.
+     */
+    ActionSchedulerId_t scheduleReloadRational(uint32_t delayedTime, uint32_t periodNum, uint8_t periodDen, ActionCallback_t cb, void* arg);
+
+    /**
+     * @brief Schedules an action with a fractional period and extra options
+     * @param delayedTime Initial delay before first execution in ticks
+     * @param periodNum Numerator of the period, in ticks
+     * @param periodDen Denominator of the period, from 1 to 255
+     * @param cb Callback function to execute
+     * @param arg User data to pass to callback
+     * @param options Per-action options, as for scheduleReload()
+     * @return ActionSchedulerId_t Unique ID for the scheduled action, or ACTION_SCHEDULER_ID_INVALID if scheduling failed
+     *
+     * Can be safely called from interrupt handlers.
+     */
+    ActionSchedulerId_t scheduleReloadRational(uint32_t delayedTime, uint32_t periodNum, uint8_t periodDen, ActionCallback_t cb, void* arg, const ActionOptions_t& options);
+#endif
+
+    /**
+     * @brief Posts an action from a producer thread without taking the scheduler lock
+     * @param delayedTime Delay before execution in ticks, and also subsequent reload period
+     * @param cb Callback function to execute
+     * @param arg User data to pass to callback
+     * @return true if the action was queued, false if the post queue is full or disabled
+     *
+     * Any number of threads can post concurrently, the actions are moved into the timeline
+     * by the thread calling proceed(), at the start of its next pass. The delay counts from then.
+     * Needs ACTION_SCHEDULER_POST_QUEUE_SIZE.
+     */
+    bool post(uint32_t delayedTime, ActionCallback_t cb, void* arg);
+
+    /**
+     * @brief Posts an action with different reload value without taking the scheduler lock
+     * @param delayedTime Initial delay before first execution in ticks
+     * @param reload Period for subsequent executions in ticks
+     * @param cb Callback function to execute
+     * @param arg User data to pass to callback
+     * @return true if the action was queued, false if the post queue is full or disabled
+     */
+    bool postReload(uint32_t delayedTime, uint32_t reload, ActionCallback_t cb, void* arg);
+
+#if ACTION_SCHEDULER_INLINE_ARG_SIZE > 0
+    /**
+     * @brief Schedules an action with a payload copied into the node
+     * @param delayedTime Initial delay before first execution in ticks
+     * @param reload Period for subsequent executions in ticks
+     * @param cb Callback function to execute, its arg points to the copy of the payload
+     * @param payload Trivially copyable data, at most ACTION_SCHEDULER_INLINE_ARG_SIZE bytes (checked at compile time)
+     * @return ActionSchedulerId_t Unique ID for the scheduled action, or ACTION_SCHEDULER_ID_INVALID if scheduling failed
+     *
+     * The copy lives as long as the action, a reloaded action sees the changes its callback made to it.
+     * Can be safely called from interrupt handlers.
+     */
+    template <typename T>
+    ActionSchedulerId_t scheduleInline(uint32_t delayedTime, uint32_t reload, ActionCallback_t cb, const T& payload) {
+        static_assert(sizeof(T) <= ACTION_SCHEDULER_INLINE_ARG_SIZE, "payload does not fit in ACTION_SCHEDULER_INLINE_ARG_SIZE");
+        static_assert(alignof(T) <= alignof(ActionInlineArg_t), "payload alignment is not supported by the inline storage");
+        static_assert(__is_trivially_copyable(T), "payload must be trivially copyable");
+        return scheduleCopy(delayedTime, reload, cb, &payload, (uint8_t)sizeof(T));
+    }
+
+    /**
+     * @brief Schedules a callable, e.g. a capturing lambda, stored in the node
+     * @param delayedTime Initial delay before first execution in ticks
+     * @param reload Period for subsequent executions in ticks
+     * @param fn Callable returning ActionReturn_t and taking no argument. It must be trivially copyable
+     *           (lambdas capturing trivially copyable values are) and fit ACTION_SCHEDULER_INLINE_ARG_SIZE
+     * @return ActionSchedulerId_t Unique ID for the scheduled action, or ACTION_SCHEDULER_ID_INVALID if scheduling failed
+     *
+     * No heap and no virtual dispatch: the callback is a static trampoline per callable type.
+     * Can be safely called from interrupt handlers.
+     */
+    template <typename F>
+    ActionSchedulerId_t scheduleLambda(uint32_t delayedTime, uint32_t reload, const F& fn) {
+        static_assert(sizeof(F) <= ACTION_SCHEDULER_INLINE_ARG_SIZE, "callable does not fit in ACTION_SCHEDULER_INLINE_ARG_SIZE");
+        static_assert(alignof(F) <= alignof(ActionInlineArg_t), "callable alignment is not supported by the inline storage");
+        static_assert(__is_trivially_copyable(F), "callable must be trivially copyable");
+        return scheduleCopy(delayedTime, reload, invokeInline<F>, &fn, (uint8_t)sizeof(F));
+    }
+#endif
+
     /**
      * @brief Cancels a scheduled action
      * @param actionId Pointer to the action ID to unschedule
@@ -122,6 +718,33 @@ public:
      */
     bool unschedule(ActionSchedulerId_t* actionId);
 
+    /**
+     * @brief Changes the reload period of a scheduled action in place
+     * @param actionId ID of the action
+     * @param reload New reload period in ticks, applied the next time the action is re-armed
+     * @return true if the action exists, false otherwise or if it was scheduled with scheduleLong() or scheduleAt()
+     *
+     * O(1), the action keeps its node and its current deadline. A callback can call it on its own ID
+     * and return ACTION_RELOAD to pick the delay of its next run. Can be safely called from interrupt handlers.
+     */
+    bool setReload(ActionSchedulerId_t actionId, uint32_t reload);
+
+    /**
+     * @brief Takes the first plain action out of the timeline that is due with no delay left
+     * @param cb Receives the callback of the action
+     * @param arg Receives the user data of the action
+     * @param reload Receives the reload period of the action
+     * @return true if an action was taken, false if no plain action is due
+     *
+     * The action is removed without being executed and its ID becomes invalid, the caller
+     * runs it and re-arms it with scheduleReload(reload, reload, cb, arg) on ACTION_RELOAD.
+     * Used to hand due work over to another scheduler. Only actions that this call fully
+     * describes are taken: one-shot, unique and fixed-delay actions, actions with options
+     * (priority, group, fractional period, deadline, reservation class, affinity) and actions
+     * carrying an inline payload (scheduleInline(), scheduleLambda()) stay here.
+     */
+    bool takeDueAction(ActionCallback_t* cb, void** arg, uint32_t* reload);
+
     /**
      * @brief Cancels all actions with the specified callback
      * @param cb Callback function to unschedule
@@ -131,30 +754,92 @@ public:
      */
     bool unscheduleAll(ActionCallback_t cb);
 
+    /**
+     * @brief Cancels all actions of a group, whatever their callbacks
+     * @param group Group ID given in ActionOptions_t::group
+     * @return true if any actions were unscheduled, false otherwise
+     *
+     * Walks the group list only, O(group size). Needs ACTION_SCHEDULER_GROUPS, spilled actions are not in a group yet.
+     */
+    bool cancelGroup(uint8_t group);
+
+    /**
+     * @brief Freezes the actions of a group until resumeGroup()
+     * @param group Group ID given in ActionOptions_t::group
+     * @return true if the group exists, false otherwise
+     *
+     * Each pending action keeps its remaining time out of the timeline, an action of the group scheduled
+     * or reloaded meanwhile is frozen as well. The timeline is walked once, up to the last action of the group.
+     * Actions parked by scheduleLong() keep their deadline. Needs ACTION_SCHEDULER_GROUPS.
+     */
+    bool suspendGroup(uint8_t group);
+
+    /**
+     * @brief Puts the actions of a suspended group back into the timeline with their frozen remaining times
+     * @param group Group ID given in ActionOptions_t::group
+     * @return true if the group exists, false otherwise
+     *
+     * Walks the group list only, and inserts each of its actions. Needs ACTION_SCHEDULER_GROUPS.
+     */
+    bool resumeGroup(uint8_t group);
+
     /**
      * @brief Removes all scheduled actions
      *
      * Clears the scheduler, removing all pending actions and resetting
-     * all internal state.
+     * all internal state. Coroutines waiting on delay() are dropped without
+     * being resumed and their frames are not freed, so clear only once none waits.
      */
     void clear(void);
 
     /**
      * @brief Gets the delay until the next scheduled event
-     * @return Delay in milliseconds until next event, or UINT32_MAX if no events are scheduled
+     * @return Delay in ticks until next event, or UINT32_MAX if no events are scheduled
      *
      * Returns the time remaining until the next scheduled action will execute.
+     * Wait-free for the writer: reads without the lock and retries if the timeline changed meanwhile.
      */
     uint32_t getNextEventDelay(void);
 
+    /**
+     * @brief Copies the next pending actions of the timeline, earliest first
+     * @param out Buffer receiving the actions
+     * @param k Maximum number of actions to copy, the size of the buffer
+     * @return Number of actions copied
+     *
+     * O(k) inside a short critical section, the remaining time of each action is summed up on the way.
+     * Actions parked by scheduleLong() and spilled actions are not part of the timeline yet.
+     */
+    uint8_t peekNext(ActionPeek_t* out, uint8_t k);
+
+    /**
+     * @brief Copies the next pending actions of the timeline without the lock
+     * @param out Buffer receiving the actions
+     * @param k Maximum number of actions to copy, the size of the buffer
+     * @return Number of actions copied
+     *
+     * Same as peekNext(), but wait-free for the writer: reads without the lock and starts over
+     * if the timeline changed meanwhile. Meant for a UI or monitor polling from another core or thread.
+     */
+    uint8_t peekNextLockFree(ActionPeek_t* out, uint8_t k);
+
     /**
      * @brief Gets the total time processed by the scheduler
-     * @return Total processed time in milliseconds
+     * @return Total processed time in ticks
      *
      * Returns the cumulative time that has been processed through proceed() calls.
+     * Reads without the lock, safe against torn reads.
      */
     uint32_t getProceedingTime(void);
 
+    /**
+     * @brief Gets the total time processed by the scheduler, without wrapping after 49.7 days
+     * @return Total processed time in ticks
+     *
+     * Reads without the lock, safe against torn reads.
+     */
+    uint64_t getProceedingTime64(void);
+
     /**
      * @brief Resets the proceeding time counter to zero
      */
@@ -166,7 +851,7 @@ public:
      * @return true if the callback is scheduled, false otherwise
      *
      * Determines if the specified callback function is currently scheduled
-     * for execution.
+     * for execution. Reads without the lock and retries if the scheduler changed meanwhile.
      */
     bool isCallbackArmed(ActionCallback_t cb);
 
@@ -175,32 +860,378 @@ public:
      * @return Maximum number of active nodes since last clear
      *
      * Returns the high water mark for number of simultaneously scheduled
-     * actions since the last clear() call.
+     * actions since the last clear() call. Reads without the lock, safe against torn reads.
      */
     uint16_t getActiveNodesWaterMark(void);
 
+    /**
+     * @brief Sets what scheduling does when the node pool is full
+     * @param policy Overflow policy, see ActionOverflowPolicy_t
+     * @return true if set, false if ACTION_OVERFLOW_SPILL is asked without ACTION_SCHEDULER_ENABLE_SPILL,
+     *         or any policy but ACTION_OVERFLOW_REJECT without ACTION_SCHEDULER_ENABLE_OVERFLOW_POLICY
+     *
+     * Evicting only considers actions waiting in the timeline, with reservation classes only one of the
+     * same class. Spilled actions are moved into the timeline, earliest deadline first, as soon as nodes
+     * free up in proceed(); if their deadline passed meanwhile they run on that pass. Actions with an
+     * inline payload and scheduleUnique() are never spilled.
+     */
+    bool setOverflowPolicy(ActionOverflowPolicy_t policy);
+
+    /**
+     * @brief Gets the number of actions rejected because the node pool was full
+     * @return Number of rejections since the last clear() call, 0 without ACTION_SCHEDULER_ENABLE_OVERFLOW_POLICY
+     */
+    uint32_t getRejectedCount(void);
+
+    /**
+     * @brief Gets the number of actions dropped by ACTION_OVERFLOW_EVICT_LATEST
+     * @return Number of evictions since the last clear() call, 0 without ACTION_SCHEDULER_ENABLE_OVERFLOW_POLICY
+     */
+    uint32_t getEvictedCount(void);
+
+    /**
+     * @brief Gets the number of actions that went to the spill store
+     * @return Number of spilled actions since the last clear() call, 0 without ACTION_SCHEDULER_ENABLE_OVERFLOW_POLICY
+     */
+    uint32_t getSpilledCount(void);
+
+    /**
+     * @brief Reserves a guaranteed minimum of slots for a reservation class
+     * @param reserveClass Class index, below ACTION_SCHEDULER_RESERVE_CLASSES
+     * @param slots Number of slots only this class can use, 0 to drop the reservation
+     * @return true if set, false if the class is out of range, the reservations would exceed
+     *         the capacity, or the pool has not enough free slots left to honour it
+     *
+     * A class first takes from its own reservation, then from the slots nobody reserved. So a flood
+     * of class 0 actions can never starve, e.g., an ISR class. Reservations are kept by clear().
+     */
+    bool setReservation(uint8_t reserveClass, uint8_t slots);
+
+    /**
+     * @brief Gets the maximum number of slots a reservation class held at once
+     * @param reserveClass Class index
+     * @return Maximum number of slots since the last clear() call, 0 if the class is out of range
+     */
+    uint8_t getClassWaterMark(uint8_t reserveClass);
+
+    /**
+     * @brief Gets the number of actions of a reservation class rejected for lack of a slot
+     * @param reserveClass Class index
+     * @return Number of rejections since the last clear() call, 0 if the class is out of range
+     */
+    uint32_t getClassRejectCount(uint8_t reserveClass);
+
+    /**
+     * @brief Sets the clock used to measure how long callbacks take
+     * @param clock Free running clock in the unit of proceed(), e.g. millis, or NULL to disable
+     *
+     * Without a clock, completion deadlines are only checked when the callback starts,
+     * and ACTION_RELOAD_FIXED_DELAY actions are re-armed relative to when their callback started.
+     */
+    void setClock(ActionSchedulerClock_t clock);
+
+    /**
+     * @brief Gets how far the latest run of an action started behind its ideal phase
+     * @param actionId ID of the action
+     * @return Phase error in ticks, 0 if the action does not exist or ACTION_SCHEDULER_ENABLE_PHASE_ERROR is 0
+     *
+     * The ideal phase is the grid of reload periods from the first deadline. A fixed-rate action stays
+     * on the grid, so this is the lateness of its latest run. A fixed-delay action moves by the lateness
+     * and the run time of each run, so this accumulates the drift since it was scheduled.
+     */
+    uint32_t getPhaseError(ActionSchedulerId_t actionId);
+
+    /**
+     * @brief Sets the hook that is called when an action misses its completion deadline
+     * @param hook Hook function, or NULL to disable. It is called from proceed() with interrupts enabled.
+     *             Needs ACTION_SCHEDULER_ENABLE_DEADLINES
+     */
+    void setDeadlineMissHook(ActionDeadlineMissHook_t hook);
+
+    /**
+     * @brief Gets the number of missed completion deadlines
+     * @return Number of misses since the last clear() call, 0 without ACTION_SCHEDULER_ENABLE_DEADLINES
+     */
+    uint32_t getDeadlineMissCount(void);
+
+    /**
+     * @brief Hands due callbacks to an executor instead of running them in proceed()
+     * @param executor Executor, e.g. pushing the job to a thread pool, or NULL to run callbacks in proceed() again
+     * @param context User context passed to the executor
+     *
+     * proceed() still collects the due actions in priority and deadline order, but only hands
+     * them over. Jobs of different affinity groups can run in parallel, a worker reports the
+     * callback result with complete(), which re-arms an ACTION_RELOAD action under the lock.
+     * Needs ACTION_SCHEDULER_ENABLE_EXECUTOR. Completion deadlines are not checked in this mode.
+     */
+    void setExecutor(ActionExecutor_t executor, void* context);
+
+    /**
+     * @brief Reports the result of a job run by the executor
+     * @param actionId ID from the ActionJob_t
+     * @param actionRet What the callback returned
+     * @return true if the action was re-armed, false if it finished or was unscheduled meanwhile
+     *
+     * Can be called from any thread. A reload is relative to the deadline the action was due at.
+     */
+    bool complete(ActionSchedulerId_t actionId, ActionReturn_t actionRet);
+
+#if ACTION_SCHEDULER_HAS_COROUTINES
+    /**
+     * @brief Suspends the awaiting coroutine for a delay: co_await scheduler.delay(50);
+     * @param delayedTime Delay before the coroutine is resumed from proceed(), in ticks
+     * @return Awaiter, the co_await yields true if resumed by the scheduler, false if no node was free
+     *         (then the coroutine continues immediately)
+     *
+     * Defined in ActionSchedulerCoroutine.h, which must be included to use it.
+     */
+    ActionDelayAwaiter delay(uint32_t delayedTime);
+#endif
+
 private:
-    typedef struct {
-        ActionCallback_t callback;
-        uint32_t delayToPrevious;
-        uint32_t reload;
-        void* arg;
-        uint8_t usedCounter;
-        uint8_t previousNodeIdx;
-        uint8_t nextNodeIdx;
-    } ActionNode_t;
+#if ACTION_SCHEDULER_HAS_COROUTINES
+    friend class ActionDelayAwaiter;
+
+    // One-shot node resuming a suspended coroutine, never evicted nor spilled as its frame would be lost
+    ActionSchedulerId_t scheduleResume(uint32_t delayedTime, ActionCallback_t cb, void* arg);
+#endif
+
+    enum {
+        ACTION_NODE_FREE,       // slot is available
+        ACTION_NODE_TIMELINE,   // linked in the timeline
+        ACTION_NODE_READY,      // due, linked in the ready queue of its priority, delayToPrevious holds the deadline
+        ACTION_NODE_RUNNING,    // callback is being executed, delayToPrevious holds the deadline
+        ACTION_NODE_PARKED,     // long delay, in the parked list, reload:delayToPrevious holds the 64-bit deadline
+        ACTION_NODE_SUSPENDED   // its group is suspended, delayToPrevious holds the frozen remaining time
+    };
+
+    enum {
+        ACTION_NODE_FLAG_UNIQUE = 0x01U,  // indexed in the unique buckets
+        ACTION_NODE_FLAG_ONESHOT = 0x02U, // runs once whatever it returns: scheduleLong() and scheduleAt()
+        ACTION_NODE_FLAG_FIXED_DELAY = 0x04U, // re-armed relative to the completion of its callback
+        ACTION_NODE_FLAG_AWAITER = 0x08U  // resumes a coroutine suspended on delay()
+    };
+
+#if ACTION_SCHEDULER_ENABLE_NODE_POOL
+    // Node idx lives in slab idx / ACTION_SCHEDULER_SLAB_NODES, NULL while that slab is not attached
+    ActionNode_t* mSlabs[ACTION_SCHEDULER_MAX_SLABS];
+    // Nodes in use per slab, and the usedCounter the nodes of a slab start from when it is attached again
+    uint8_t mSlabUsed[ACTION_SCHEDULER_MAX_SLABS];
+    uint8_t mSlabSeed[ACTION_SCHEDULER_MAX_SLABS];
+    ActionNodePool* mPool;
+
+    ActionNode_t& nodeAt(uint8_t idx) {
+        return mSlabs[idx / ACTION_SCHEDULER_SLAB_NODES][idx % ACTION_SCHEDULER_SLAB_NODES];
+    }
+    bool hasNodeAt(uint8_t idx) {
+        return mSlabs[idx / ACTION_SCHEDULER_SLAB_NODES] != NULL;
+    }
+    // For the lock-free readers, the slab can go away under them, NULL then
+    ActionNode_t* peekNodeAt(uint8_t idx) {
+        ActionNode_t* slab = __atomic_load_n(&mSlabs[idx / ACTION_SCHEDULER_SLAB_NODES], __ATOMIC_RELAXED);
+        return (slab != NULL) ? &slab[idx % ACTION_SCHEDULER_SLAB_NODES] : NULL;
+    }
+    bool attachSlab(uint8_t* slotIdx);
+    void detachSlab(uint8_t slab);
+#else
+    ActionNode_t* mNodes;
 
-    ActionNode_t mNodes[ACTION_SCHEDULER_MAX_NODES];
+    ActionNode_t& nodeAt(uint8_t idx) {
+        return mNodes[idx];
+    }
+    bool hasNodeAt(uint8_t idx) {
+        (void)idx;
+        return true;
+    }
+    ActionNode_t* peekNodeAt(uint8_t idx) {
+        return &mNodes[idx];
+    }
+#endif
+    uint8_t levelAt(uint8_t idx) {
+#if ACTION_SCHEDULER_PRIORITY_LEVELS > 1
+        return nodeAt(idx).priority;
+#else
+        (void)idx;
+        return 0U;
+#endif
+    }
+    uint8_t mCapacity;
     uint8_t mNodeStartIdx;
     uint8_t mNodeEndIdx;
     uint16_t mActiveNodes;
     uint32_t mProceedingTime;
+    // Number of times mProceedingTime wrapped, the upper half of the 64-bit time
+    uint32_t mProceedingEpoch;
+    // Head of the parked list, UINT8_MAX for empty, and the proceeding time of its next scan
+    uint8_t mParkedHead;
+    uint32_t mHorizonCheck;
+    // Nodes due within this many ticks are collected early, set for the length of a proceedWindow() pass
+    uint32_t mCollectWindow;
     uint16_t mActiveNodesWaterMark;
+    // Last node inserted into the timeline, nodes landing on the same deadline are grouped right behind it
+    uint8_t mGroupAnchorIdx;
+    uint8_t mGroupAnchorCounter;
+    uint32_t mGroupAnchorDeadline;
+    // Ready queues per priority level, UINT8_MAX for empty, and a bit per non-empty level
+    uint8_t mReadyHead[ACTION_SCHEDULER_PRIORITY_LEVELS];
+    uint8_t mReadyTail[ACTION_SCHEDULER_PRIORITY_LEVELS];
+    uint8_t mReadyMask;
+#if ACTION_SCHEDULER_UNIQUE_BUCKETS > 0
+    // Heads of the unique index chains, UINT8_MAX for empty
+    uint8_t mUniqueBuckets[ACTION_SCHEDULER_UNIQUE_BUCKETS];
+#endif
+#if ACTION_SCHEDULER_GROUPS > 0
+    // Heads of the group lists, UINT8_MAX for empty, and whether each group is suspended
+    uint8_t mGroupHeads[ACTION_SCHEDULER_GROUPS];
+    bool mGroupSuspended[ACTION_SCHEDULER_GROUPS];
+#endif
+    ActionSchedulerClock_t mClock;
+#if ACTION_SCHEDULER_ENABLE_DEADLINES
+    ActionDeadlineMissHook_t mDeadlineMissHook;
+    uint32_t mDeadlineMissCount;
+#endif
+    // Sequence lock counter, odd while a critical section is changing the state
+#if defined(__AVR__)
+    // A reader only races with an interrupt there, and loads one byte atomically
+    typedef uint8_t ActionSequence_t;
+#else
+    // A reader preempted by another thread must not see the counter wrap around to its value
+    typedef uint32_t ActionSequence_t;
+#endif
+    ActionSequence_t mSequence;
+#if ACTION_SCHEDULER_ENABLE_EXECUTOR
+    ActionExecutor_t mExecutor;
+    void* mExecutorContext;
+#endif
+#if ACTION_SCHEDULER_ENABLE_OVERFLOW_POLICY
+    ActionOverflowPolicy_t mOverflowPolicy;
+    uint32_t mRejectedCount;
+    uint32_t mEvictedCount;
+    uint32_t mSpilledCount;
+#endif
+#if ACTION_SCHEDULER_ENABLE_SPILL
+    typedef struct {
+        ActionCallback_t callback;
+        void* arg;
+        uint32_t deadline;
+        uint32_t reload;
+        ActionOptions_t options;
+        uint8_t flags;  // node flags to restore on merge, e.g. the one-shot of scheduleAt()
+    } ActionSpill_t;
+
+    // Sorted by deadline, latest first, so the next one to merge back is at the end
+    ActionSpill_t* mSpill;
+    uint16_t mSpillCount;
+    uint16_t mSpillCapacity;
+
+    bool spillAction(uint32_t delayedTime, uint32_t reload, ActionCallback_t cb, void* arg, const ActionOptions_t& options, uint8_t flags);
+    void mergeSpill(void);
+#endif
+    ActionSchedulerId_t handleOverflow(uint32_t delayedTime, uint32_t reload, ActionCallback_t cb, void* arg, const ActionOptions_t& options, const void* inlineArg, uint8_t inlineSize, uint8_t flags);
+    ActionSchedulerId_t createOrOverflow(uint32_t delayedTime, uint32_t reload, ActionCallback_t cb, void* arg, const ActionOptions_t& options, const void* inlineArg, uint8_t inlineSize, uint8_t flags);
+    uint32_t getDelayUntil(uint32_t deadline, uint32_t reload);
+    bool isPlainAt(uint8_t idx);
+#if ACTION_SCHEDULER_RESERVE_CLASSES > 0
+    // Slots reserved and held per class, and the reserved slots not held yet, which nobody else can take
+    uint8_t mClassReserved[ACTION_SCHEDULER_RESERVE_CLASSES];
+    uint8_t mClassUsed[ACTION_SCHEDULER_RESERVE_CLASSES];
+    uint8_t mClassWaterMark[ACTION_SCHEDULER_RESERVE_CLASSES];
+    uint32_t mClassRejectCount[ACTION_SCHEDULER_RESERVE_CLASSES];
+    uint16_t mReservedIdle;
+    uint16_t mUsedNodes;
+
+    bool reserveSlot(uint8_t reserveClass);
+    void returnSlot(uint8_t reserveClass);
+#endif
+#if ACTION_SCHEDULER_POST_QUEUE_SIZE > 0
+    // Bounded multi-producer single-consumer queue, each cell carries a sequence telling whose turn it is
+    typedef struct {
+        uint16_t sequence;
+        ActionCallback_t callback;
+        void* arg;
+        uint32_t delayedTime;
+        uint32_t reload;
+    } ActionPostCell_t;
+
+    ActionPostCell_t mPostCells[ACTION_SCHEDULER_POST_QUEUE_SIZE];
+    uint16_t mPostEnqueuePos;
+    uint16_t mPostDequeuePos;
 
+    void drainPostQueue(void);
+#endif
+
+    ActionSchedulerId_t scheduleNode(uint32_t delayedTime, uint32_t reload, ActionCallback_t cb, void* arg, const ActionOptions_t& options, const void* inlineArg, uint8_t inlineSize);
+    bool createNode(uint8_t* slotIdx, uint32_t delayedTime, uint32_t reload, ActionCallback_t cb, void* arg, const ActionOptions_t& options, const void* inlineArg, uint8_t inlineSize);
+#if ACTION_SCHEDULER_UNIQUE_BUCKETS > 0
+    uint8_t uniqueBucketOf(ActionCallback_t cb, void* arg);
+    uint8_t findUniqueNode(ActionCallback_t cb, void* arg);
+    void removeUniqueNode(uint8_t idx);
+    void restartNodeAt(uint8_t idx, uint32_t delay);
+#endif
+    uint32_t getRemainingTimeAt(uint8_t idx);
+    bool allocNode(uint8_t* slotIdx, uint32_t reload, ActionCallback_t cb, void* arg, const ActionOptions_t& options, const void* inlineArg, uint8_t inlineSize);
+    uint64_t getNow64(void);
+    void parkNodeAt(uint8_t idx, uint64_t deadline);
+    void unparkNodeAt(uint8_t idx);
+    void unparkDueNodes(void);
+#if ACTION_SCHEDULER_GROUPS > 0
+    void linkGroupNodeAt(uint8_t idx);
+    void unlinkGroupNodeAt(uint8_t idx);
+#endif
+    bool freezeNodeAt(uint8_t idx, uint32_t delay);
+#if ACTION_SCHEDULER_INLINE_ARG_SIZE > 0
+    ActionSchedulerId_t scheduleCopy(uint32_t delayedTime, uint32_t reload, ActionCallback_t cb, const void* inlineArg, uint8_t inlineSize);
+
+    template <typename F>
+    static ActionReturn_t invokeInline(void* storage) {
+        return (*(F*)storage)();
+    }
+#endif
+    void enterCriticalSection(void);
+    void exitCriticalSection(void);
+    ActionSequence_t readBegin(void);
+    bool readRetry(ActionSequence_t sequence);
     bool getFreeSlot(uint8_t* slotIdx);
     uint16_t generateActionIdAt(uint8_t idx);
+    bool isNodeLinked(uint8_t idx);
+    void releaseNodeAt(uint8_t idx);
     void removeNodeAt(uint8_t idx);
+    void unlinkNodeAt(uint8_t idx);
     void insertNode(uint8_t idx, uint32_t delay);
+    void linkNode(uint8_t idx, uint32_t delay);
+    void pushReadyNode(uint8_t idx);
+    void unlinkReadyNodeAt(uint8_t idx);
+    uint32_t readyKeyAt(uint8_t idx);
+    bool popReadyNode(uint8_t* idx);
+    void queueDueNodes(uint32_t ticksElapsed);
+    void collectDueNodes(uint32_t* ticksElapsed);
+    void advanceTime(uint32_t ticks);
+    bool runPass(uint32_t ticksElapsed, uint32_t window);
+    void reloadNodeAt(uint8_t idx, uint32_t runTime);
+    void startRunAt(uint8_t idx, uint32_t ticksPending);
+    bool insertNodeGrouped(uint8_t idx, uint32_t delay);
+    void setGroupAnchor(uint8_t idx, uint32_t delay);
+};
+
+/**
+ * @class ActionScheduler
+ * @brief ActionSchedulerCore with ACTION_SCHEDULER_MAX_NODES nodes of storage inside the instance
+ */
+class ActionScheduler : public ActionSchedulerCore {
+public:
+    /**
+     * @brief Constructs a new ActionScheduler instance
+     *
+     * Initializes an empty scheduler with no active nodes.
+     */
+    ActionScheduler();
+
+private:
+    ActionNode_t mNodeStorage[ACTION_SCHEDULER_MAX_NODES];
+
+    // The core points into this instance, a copy would share the nodes of the original
+    ActionScheduler(const ActionScheduler&);
+    ActionScheduler& operator=(const ActionScheduler&);
 };
 
 #endif /* ACTION_SCHEDULER_H */
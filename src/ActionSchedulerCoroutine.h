@@ -0,0 +1,103 @@
+/**
+ * @file ActionSchedulerCoroutine.h
+ * @brief C++20 coroutine support for ActionScheduler.
+ * @author windy.yam0@gmail.com
+ *
+ * Instead of a chain of schedule() calls passing state through the void* arg, a protocol
+ * handler can be written as one coroutine that keeps its state in local variables:
+ *
+ *     ActionTask blink(ActionSchedulerCore& scheduler) {
+ *         for (;;) {
+ *             digitalWrite(ledPin, HIGH);
+ *             co_await scheduler.delay(100);
+ *             digitalWrite(ledPin, LOW);
+ *             co_await scheduler.delay(900);
+ *         }
+ *     }
+ *
+ * Every co_await takes one one-shot node of the scheduler, whose callback resumes the
+ * coroutine from proceed(). There is no allocation beyond the coroutine frame itself.
+ * These nodes are never evicted by ACTION_OVERFLOW_EVICT_LATEST, but clear() drops them
+ * without resuming the coroutines, whose frames are then never freed.
+ * Needs a compiler with C++20 coroutines (e.g. GCC 10+ with -std=c++20).
+ */
+
+#ifndef ACTION_SCHEDULER_COROUTINE_H
+#define ACTION_SCHEDULER_COROUTINE_H
+
+#include "ActionScheduler.h"
+
+#if ACTION_SCHEDULER_HAS_COROUTINES
+
+#include <coroutine>
+
+/**
+ * @class ActionDelayAwaiter
+ * @brief Awaitable returned by ActionSchedulerCore::delay()
+ */
+class ActionDelayAwaiter {
+public:
+    ActionDelayAwaiter(ActionSchedulerCore& scheduler, uint32_t delayedTime) noexcept
+        : mScheduler(scheduler)
+        , mDelayedTime(delayedTime)
+        , mScheduled(false)
+    {
+    }
+
+    bool await_ready() const noexcept {
+        // even a zero delay goes through the scheduler, so it yields to the other due actions
+        return false;
+    }
+
+    bool await_suspend(std::coroutine_handle<> handle) noexcept {
+        // Once the node is published, another thread may resume and even destroy the frame holding
+        // this awaiter, so the state is set up front and the awaiter is not touched afterwards
+        mScheduled = true;
+        if (mScheduler.scheduleResume(mDelayedTime, onResume, handle.address()) == ACTION_SCHEDULER_ID_INVALID)
+        {
+            // no free node: don't suspend, the coroutine continues and sees false
+            mScheduled = false;
+            return false;
+        }
+        return true;
+    }
+
+    bool await_resume() const noexcept {
+        return mScheduled;
+    }
+
+private:
+    ActionSchedulerCore& mScheduler;
+    uint32_t mDelayedTime;
+    bool mScheduled;
+
+    static ActionReturn_t onResume(void* arg) {
+        std::coroutine_handle<>::from_address(arg).resume();
+        return ACTION_ONESHOT;
+    }
+};
+
+inline ActionDelayAwaiter ActionSchedulerCore::delay(uint32_t delayedTime) {
+    return ActionDelayAwaiter(*this, delayedTime);
+}
+
+/**
+ * @class ActionTask
+ * @brief Fire-and-forget coroutine return type
+ *
+ * The coroutine starts running when called and its frame is freed when it returns.
+ */
+class ActionTask {
+public:
+    struct promise_type {
+        ActionTask get_return_object() noexcept { return ActionTask(); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { abort(); }
+    };
+};
+
+#endif /* ACTION_SCHEDULER_HAS_COROUTINES */
+
+#endif /* ACTION_SCHEDULER_COROUTINE_H */
@@ -0,0 +1,209 @@
+/**
+ * @file ShardedActionScheduler.h
+ * @brief One ActionScheduler per core or thread, with cross-shard scheduling and work stealing.
+ * @author windy.yam0@gmail.com
+ *
+ * Each event loop owns one shard and calls proceed() with its own shard index.
+ * New actions go to the local shard (as told by the shard resolver), other shards
+ * can be targeted explicitly. An event loop that has nothing to do in a pass steals
+ * one action that is already due on another shard, so a burst of zero-delay work
+ * posted to one shard is spread over the idle ones.
+ *
+ * IDs returned here encode the owning shard in the upper 16 bits and the ID of the
+ * shard's own scheduler in the lower 16 bits.
+ *
+ * Note: the shards still take the critical section of ActionScheduler, i.e. whatever
+ * noInterrupts()/interrupts() are mapped to. For producers on other threads, postTo()
+ * uses the lock-free post queue when ACTION_SCHEDULER_POST_QUEUE_SIZE is enabled.
+ */
+
+#ifndef SHARDED_ACTION_SCHEDULER_H
+#define SHARDED_ACTION_SCHEDULER_H
+
+#include <Arduino.h>
+#include "ActionScheduler.h"
+
+/**
+ * @brief Type definition for sharded action IDs, shard index << 16 | shard action ID
+ */
+typedef uint32_t ShardedActionId_t;
+
+/**
+ * @brief Invalid sharded action ID value
+ */
+#define SHARDED_ACTION_ID_INVALID UINT32_MAX
+
+/**
+ * @class ShardedActionScheduler
+ * @brief Owns SHARDS scheduler instances and routes actions between them
+ * @tparam SHARDS Number of shards, one per core or event loop thread
+ */
+template <uint8_t SHARDS>
+class ShardedActionScheduler {
+public:
+    /**
+     * @brief Function pointer type returning the shard index of the calling core or thread
+     */
+    typedef uint8_t (*ShardResolver_t)(void);
+
+    /**
+     * @brief Constructs the shards, all actions go to shard 0 until a resolver is set
+     */
+    ShardedActionScheduler() : mResolver(NULL), mStealCount(0) {}
+
+    /**
+     * @brief Sets the function telling which shard is local to the caller
+     * @param resolver Resolver, e.g. returning the core ID, or NULL to always use shard 0
+     */
+    void setShardResolver(ShardResolver_t resolver) {
+        mResolver = resolver;
+    }
+
+    /**
+     * @brief Gives access to one shard
+     * @param shard Shard index
+     * @return Pointer to the shard's scheduler, or NULL if the shard index is invalid
+     */
+    ActionScheduler* getShard(uint8_t shard) {
+        return (shard < SHARDS) ? &mShards[shard] : NULL;
+    }
+
+    /**
+     * @brief Schedules an action on the local shard
+     * @return ShardedActionId_t ID encoding the shard, or SHARDED_ACTION_ID_INVALID if scheduling failed
+     */
+    ShardedActionId_t schedule(uint32_t delayedTime, ActionCallback_t cb, void* arg) {
+        return scheduleOn(localShard(), delayedTime, delayedTime, cb, arg);
+    }
+
+    /**
+     * @brief Schedules an action with different reload value on the local shard
+     * @return ShardedActionId_t ID encoding the shard, or SHARDED_ACTION_ID_INVALID if scheduling failed
+     */
+    ShardedActionId_t scheduleReload(uint32_t delayedTime, uint32_t reload, ActionCallback_t cb, void* arg) {
+        return scheduleOn(localShard(), delayedTime, reload, cb, arg);
+    }
+
+    /**
+     * @brief Schedules an action on a given shard
+     * @param shard Target shard index
+     * @return ShardedActionId_t ID encoding the shard, or SHARDED_ACTION_ID_INVALID if scheduling failed
+     */
+    ShardedActionId_t scheduleOn(uint8_t shard, uint32_t delayedTime, uint32_t reload, ActionCallback_t cb, void* arg) {
+        if (shard >= SHARDS)
+        {
+            return SHARDED_ACTION_ID_INVALID;
+        }
+        ActionSchedulerId_t id = mShards[shard].scheduleReload(delayedTime, reload, cb, arg);
+        if (id == ACTION_SCHEDULER_ID_INVALID)
+        {
+            return SHARDED_ACTION_ID_INVALID;
+        }
+        return ((ShardedActionId_t)shard << 16) | id;
+    }
+
+    /**
+     * @brief Posts an action to a given shard without taking its lock
+     * @return true if queued, false if the shard index is invalid or the post queue is full or disabled
+     */
+    bool postTo(uint8_t shard, uint32_t delayedTime, ActionCallback_t cb, void* arg) {
+        return (shard < SHARDS) && mShards[shard].post(delayedTime, cb, arg);
+    }
+
+    /**
+     * @brief Cancels a scheduled action on whichever shard owns it
+     * @param actionId Pointer to the sharded action ID, invalidated on success
+     * @return true if action was successfully unscheduled, false otherwise
+     */
+    bool unschedule(ShardedActionId_t* actionId) {
+        uint8_t shard = getShardOf(*actionId);
+        if ((*actionId == SHARDED_ACTION_ID_INVALID) || (shard >= SHARDS))
+        {
+            return false;
+        }
+        ActionSchedulerId_t id = (ActionSchedulerId_t)(*actionId & 0xffffU);
+        bool ret = mShards[shard].unschedule(&id);
+        if (ret)
+        {
+            *actionId = SHARDED_ACTION_ID_INVALID;
+        }
+        return ret;
+    }
+
+    /**
+     * @brief Processes elapsed time on one shard, and steals due work if it had nothing to do
+     * @param shard Shard index of the calling event loop
+     * @param ticksElapsed Time elapsed since last proceed call of this shard in ticks
+     * @return true if any callbacks were executed, false otherwise or if the shard index is invalid
+     */
+    bool proceed(uint8_t shard, uint32_t ticksElapsed) {
+        if (shard >= SHARDS)
+        {
+            return false;
+        }
+        bool ret = mShards[shard].proceed(ticksElapsed);
+        if (!ret)
+        {
+            ret = steal(shard);
+        }
+        return ret;
+    }
+
+    /**
+     * @brief Runs one action that is already due on another shard
+     * @param thief Shard index of the calling event loop, a reloaded action stays on this shard
+     * @return true if an action was stolen and executed, false if none was or the shard index is invalid
+     *
+     * The stolen action's ID becomes invalid. Only plain actions are stolen, i.e. those
+     * scheduled without options, as ActionScheduler::takeDueAction() tells.
+     */
+    bool steal(uint8_t thief) {
+        if (thief >= SHARDS)
+        {
+            return false;
+        }
+        for (uint8_t i = 1U; i < SHARDS; i++)
+        {
+            uint8_t victim = (uint8_t)((thief + i) % SHARDS);
+            ActionCallback_t cb;
+            void* arg;
+            uint32_t reload;
+            if (mShards[victim].takeDueAction(&cb, &arg, &reload))
+            {
+                if (cb(arg) == ACTION_RELOAD)
+                {
+                    mShards[thief].scheduleReload(reload, reload, cb, arg);
+                }
+                __atomic_fetch_add(&mStealCount, 1U, __ATOMIC_RELAXED);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Gets the number of actions stolen between shards
+     */
+    uint32_t getStealCount(void) {
+        return __atomic_load_n(&mStealCount, __ATOMIC_RELAXED);
+    }
+
+    /**
+     * @brief Gets the shard index encoded in a sharded action ID
+     */
+    static uint8_t getShardOf(ShardedActionId_t actionId) {
+        return (uint8_t)(actionId >> 16);
+    }
+
+private:
+    ActionScheduler mShards[SHARDS];
+    ShardResolver_t mResolver;
+    uint32_t mStealCount;
+
+    uint8_t localShard(void) {
+        uint8_t shard = (mResolver != NULL) ? mResolver() : 0U;
+        return (shard < SHARDS) ? shard : 0U;
+    }
+};
+
+#endif /* SHARDED_ACTION_SCHEDULER_H */